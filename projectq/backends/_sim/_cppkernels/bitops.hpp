@@ -0,0 +1,138 @@
+// Copyright 2017 ProjectQ-Framework (www.projectq.ch)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef BITOPS_HPP_
+#define BITOPS_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#if defined(__BMI2__) && defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+// Inserts a zero bit at each of the num positions pos[0] < pos[1] < ... into
+// x (positions refer to the result). Enumerating x = 0, 1, ... thus yields all
+// indices which have these bits cleared, in increasing order.
+inline std::size_t insert_zero_bits(std::size_t x, unsigned const* pos, unsigned num){
+    for (unsigned i = 0; i < num; ++i){
+        std::size_t low = x & ((std::size_t(1) << pos[i]) - 1);
+        x = ((x >> pos[i]) << (pos[i] + 1)) | low;
+    }
+    return x;
+}
+
+// Stores the num (distinct) positions ids[0], ... together with the
+// positions of the bits set in mask in ascending order in pos (which needs
+// room for num + popcount(mask) entries) and returns their number, e.g. to
+// enumerate all indices with the bits in mask set via
+// insert_zero_bits(x, pos, count) | mask.
+inline unsigned sorted_positions(unsigned const* ids, unsigned num, std::size_t mask, unsigned* pos){
+    unsigned count = 0;
+    for (unsigned i = 0; i < num; ++i)
+        pos[count++] = ids[i];
+    for (unsigned p = 0; mask; ++p, mask >>= 1)
+        if (mask & 1)
+            pos[count++] = p;
+    std::sort(pos, pos + count);
+    return count;
+}
+
+// Returns true if an odd number of bits is set in x.
+inline bool parity(std::size_t x){
+#if defined(__GNUC__)
+    return __builtin_parityll(x);
+#else
+    std::uint64_t y = x;
+    y ^= y >> 32;
+    y ^= y >> 16;
+    y ^= y >> 8;
+    y ^= y >> 4;
+    y ^= y >> 2;
+    y ^= y >> 1;
+    return y & 1;
+#endif
+}
+
+// Returns the number of bits set in x.
+inline unsigned popcount(std::size_t x){
+#if defined(__GNUC__)
+    return __builtin_popcountll(x);
+#else
+    unsigned cnt = 0;
+    for (; x; x &= x - 1)
+        ++cnt;
+    return cnt;
+#endif
+}
+
+// Returns the number of trailing zero bits of x (x must not be 0).
+inline unsigned ctz(std::uint64_t x){
+#if defined(__GNUC__)
+    return __builtin_ctzll(x);
+#else
+    unsigned cnt = 0;
+    for (; (x & 1) == 0; x >>= 1)
+        ++cnt;
+    return cnt;
+#endif
+}
+
+// Gathers the bits of x at the num positions pos[0], pos[1], ... into the
+// low bits of the result (bit i of the result is bit pos[i] of x).
+inline std::uint64_t extract_bits(std::size_t x, unsigned const* pos, unsigned num){
+    std::uint64_t res = 0;
+    for (unsigned i = 0; i < num; ++i)
+        res |= static_cast<std::uint64_t>((x >> pos[i]) & 1) << i;
+    return res;
+}
+
+// Scatters the low num bits of x to the positions pos[0], pos[1], ... (bit
+// pos[i] of the result is bit i of x), i.e., the inverse of extract_bits.
+inline std::size_t deposit_bits(std::uint64_t x, unsigned const* pos, unsigned num){
+    std::size_t res = 0;
+    for (unsigned i = 0; i < num; ++i)
+        res |= static_cast<std::size_t>((x >> i) & 1) << pos[i];
+    return res;
+}
+
+// Gathers the bits of x selected by mask into the low bits of the result
+// (in ascending order of their positions), i.e., pext.
+inline std::uint64_t gather_bits(std::uint64_t x, std::uint64_t mask){
+#if defined(__BMI2__) && defined(__x86_64__)
+    return _pext_u64(x, mask);
+#else
+    std::uint64_t res = 0;
+    for (std::uint64_t bit = 1; mask; bit <<= 1, mask &= mask - 1)
+        if (x & mask & (~mask + 1))
+            res |= bit;
+    return res;
+#endif
+}
+
+// Scatters the low bits of x to the positions selected by mask (in
+// ascending order), i.e., pdep.
+inline std::uint64_t scatter_bits(std::uint64_t x, std::uint64_t mask){
+#if defined(__BMI2__) && defined(__x86_64__)
+    return _pdep_u64(x, mask);
+#else
+    std::uint64_t res = 0;
+    for (std::uint64_t bit = 1; mask; bit <<= 1, mask &= mask - 1)
+        if (x & bit)
+            res |= mask & (~mask + 1);
+    return res;
+#endif
+}
+
+#endif
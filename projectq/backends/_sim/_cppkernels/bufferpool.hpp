@@ -0,0 +1,137 @@
+// Copyright 2017 ProjectQ-Framework (www.projectq.ch)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef BUFFER_POOL_HPP_
+#define BUFFER_POOL_HPP_
+
+#include <vector>
+#include <cstddef>
+#include <utility>
+#include <limits>
+
+// Pool of large (state-sized) buffers owned by a single simulator instance.
+// Buffers are kept in power-of-two size classes (by capacity) and recycled
+// to avoid costly reallocations; at most max_per_class buffers are cached
+// per size class and at most max_bytes in total (smallest buffers are evicted
+// first), all other released buffers are freed. The simulator adjusts
+// max_bytes to the size of its state vector.
+template <class Vector>
+class BufferPool{
+public:
+    struct Statistics{
+        std::size_t hits = 0;       // acquisitions served from the pool
+        std::size_t misses = 0;     // acquisitions which had to allocate
+        std::size_t releases = 0;   // buffers returned to the pool
+        std::size_t bytes_held = 0; // memory currently cached by the pool
+        std::size_t peak_bytes_held = 0;
+    };
+
+    BufferPool(unsigned max_per_class = 2,
+               std::size_t max_bytes = std::numeric_limits<std::size_t>::max())
+    : max_per_class_(max_per_class), max_bytes_(max_bytes) {}
+
+    // returns a buffer holding n elements (the contents are unspecified)
+    Vector acquire(std::size_t n){
+        Vector buf;
+        for (unsigned c = size_class(n, true); c < classes_.size(); ++c){
+            if (classes_[c].size() > 0){
+                std::swap(buf, classes_[c].back());
+                classes_[c].pop_back();
+                stats_.bytes_held -= bytes(buf);
+                break;
+            }
+        }
+        if (buf.capacity() >= n)
+            stats_.hits++;
+        else{
+            stats_.misses++;
+            buf.reserve(std::size_t(1) << size_class(n, true));
+        }
+        buf.resize(n);
+        return buf;
+    }
+
+    // hands a buffer back to the pool (frees it if its size class is full)
+    void release(Vector&& buf){
+        if (buf.capacity() == 0)
+            return;
+        stats_.releases++;
+        unsigned c = size_class(buf.capacity(), false);
+        if (classes_.size() <= c)
+            classes_.resize(c + 1);
+        if (classes_[c].size() >= max_per_class_ || bytes(buf) > max_bytes_)
+            return;
+        stats_.bytes_held += bytes(buf);
+        classes_[c].push_back(std::move(buf));
+        for (std::size_t k = 0; k < classes_.size() && stats_.bytes_held > max_bytes_; ++k){
+            while (classes_[k].size() > 0 && stats_.bytes_held > max_bytes_){
+                stats_.bytes_held -= bytes(classes_[k].back());
+                classes_[k].pop_back();
+            }
+        }
+        if (stats_.bytes_held > stats_.peak_bytes_held)
+            stats_.peak_bytes_held = stats_.bytes_held;
+    }
+
+    // makes sure that `count` buffers with at least n elements are cached
+    void reserve(std::size_t n, unsigned count = 1){
+        std::vector<Vector> bufs;
+        for (unsigned i = 0; i < count; ++i)
+            bufs.push_back(acquire(n));
+        for (auto& buf : bufs)
+            release(std::move(buf));
+    }
+
+    // frees cached buffers (largest first) until at most max_bytes are held
+    void trim(std::size_t max_bytes = 0){
+        for (std::size_t c = classes_.size(); c-- > 0 && stats_.bytes_held > max_bytes;){
+            while (classes_[c].size() > 0 && stats_.bytes_held > max_bytes){
+                stats_.bytes_held -= bytes(classes_[c].back());
+                classes_[c].pop_back();
+            }
+        }
+    }
+
+    // limits the memory held by the pool (trims it if necessary)
+    void set_max_bytes(std::size_t max_bytes){
+        max_bytes_ = max_bytes;
+        trim(max_bytes);
+    }
+
+    Statistics const& statistics() const{
+        return stats_;
+    }
+
+private:
+    static std::size_t bytes(Vector const& buf){
+        return buf.capacity() * sizeof(typename Vector::value_type);
+    }
+
+    // log2 of n, rounded up (e.g. for requests) or down (e.g. for capacities)
+    static unsigned size_class(std::size_t n, bool round_up){
+        unsigned c = 0;
+        while ((std::size_t(2) << c) <= n)
+            ++c;
+        if (round_up && (std::size_t(1) << c) < n)
+            ++c;
+        return c;
+    }
+
+    unsigned max_per_class_;
+    std::size_t max_bytes_;
+    std::vector<std::vector<Vector>> classes_;
+    Statistics stats_;
+};
+
+#endif
@@ -0,0 +1,73 @@
+// Copyright 2017 ProjectQ-Framework (www.projectq.ch)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FLAT_MATRIX_HPP_
+#define FLAT_MATRIX_HPP_
+
+#include <vector>
+#include <utility>
+#include <cstddef>
+#include <initializer_list>
+#include "intrin/alignedallocator.hpp"
+
+// Square matrix stored row by row in one contiguous, aligned array. m[r] is a
+// pointer to row r, such that m[r][c] can be used like for nested vectors.
+template <class T>
+class FlatMatrix{
+public:
+    using value_type = T;
+
+    FlatMatrix() : dim_(0) {}
+
+    explicit FlatMatrix(std::size_t dim, T const& value = T()) : dim_(dim), data_(dim * dim, value) {}
+
+    FlatMatrix(std::initializer_list<std::initializer_list<T>> rows) : dim_(rows.size()), data_(){
+        data_.reserve(dim_ * dim_);
+        for (auto const& row : rows)
+            data_.insert(data_.end(), row.begin(), row.end());
+        data_.resize(dim_ * dim_);
+    }
+
+    // copies a matrix given as a vector of rows (e.g. nested std::vectors)
+    template <class M, class = decltype(std::declval<M const&>()[0][0])>
+    explicit FlatMatrix(M const& m) : dim_(m.size()), data_(m.size() * m.size()){
+        for (std::size_t r = 0; r < dim_; ++r){
+            for (std::size_t c = 0; c < dim_; ++c)
+                data_[r * dim_ + c] = m[r][c];
+        }
+    }
+
+    static FlatMatrix identity(std::size_t dim){
+        FlatMatrix m(dim);
+        for (std::size_t i = 0; i < dim; ++i)
+            m[i][i] = T(1);
+        return m;
+    }
+
+    // number of rows (and columns)
+    std::size_t size() const { return dim_; }
+
+    T* operator[](std::size_t r) { return data_.data() + r * dim_; }
+    T const* operator[](std::size_t r) const { return data_.data() + r * dim_; }
+
+    // all dim^2 entries, row by row
+    T* data() { return data_.data(); }
+    T const* data() const { return data_.data(); }
+
+private:
+    std::size_t dim_;
+    std::vector<T, aligned_allocator<T, 64>> data_;
+};
+
+#endif
@@ -20,15 +20,18 @@
 #include <complex>
 #include <algorithm>
 #include <iostream>
-#include "intrin/alignedallocator.hpp"
+#include <iterator>
+#include <utility>
+#include "flatmatrix.hpp"
+#include "bitops.hpp"
 
 class Item{
 public:
     using Index = unsigned;
     using IndexVector = std::vector<Index>;
     using Complex = std::complex<double>;
-    using Matrix = std::vector<std::vector<Complex, aligned_allocator<Complex, 64>>>;
-    Item(Matrix mat, IndexVector idx) : mat_(mat), idx_(idx) {}
+    using Matrix = FlatMatrix<Complex>;
+    Item(Matrix mat, IndexVector idx) : mat_(std::move(mat)), idx_(std::move(idx)) {}
     Matrix& get_matrix() { return mat_; }
     IndexVector& get_indices() { return idx_; }
 private:
@@ -36,85 +39,279 @@ private:
     IndexVector idx_;
 };
 
+// Product of diagonal gates acting on the qubits idx (in ascending order):
+// entry k of diag is the phase of the basis states in which qubit idx[l] is
+// equal to bit l of k.
+class DiagonalItem{
+public:
+    using Index = unsigned;
+    using IndexVector = std::vector<Index>;
+    using Complex = std::complex<double>;
+    DiagonalItem(std::vector<Complex> diag, IndexVector idx) : diag_(std::move(diag)), idx_(std::move(idx)) {}
+    std::vector<Complex>& get_diagonal() { return diag_; }
+    std::vector<Complex> const& get_diagonal() const { return diag_; }
+    IndexVector const& get_indices() const { return idx_; }
+
+    // extends the item to the (sorted) qubits idx, which contain idx_
+    void extend(IndexVector const& idx){
+        std::vector<Complex> diag(1UL << idx.size());
+        std::vector<unsigned> bit(idx_.size());
+        for (std::size_t l = 0; l < idx_.size(); ++l)
+            bit[l] = std::lower_bound(idx.begin(), idx.end(), idx_[l]) - idx.begin();
+        for (std::size_t k = 0; k < diag.size(); ++k){
+            std::size_t local_k = 0;
+            for (std::size_t l = 0; l < idx_.size(); ++l)
+                local_k |= ((k >> bit[l]) & 1UL) << l;
+            diag[k] = diag_[local_k];
+        }
+        diag_ = std::move(diag);
+        idx_ = idx;
+    }
+
+    // multiplies the item by the diagonal gate on the qubits idx (which have
+    // to be a subset of idx_)
+    void multiply(std::vector<Complex> const& diag, IndexVector const& idx){
+        std::vector<unsigned> bit(idx.size());
+        for (std::size_t l = 0; l < idx.size(); ++l)
+            bit[l] = std::lower_bound(idx_.begin(), idx_.end(), idx[l]) - idx_.begin();
+        for (std::size_t k = 0; k < diag_.size(); ++k){
+            std::size_t local_k = 0;
+            for (std::size_t l = 0; l < idx.size(); ++l)
+                local_k |= ((k >> bit[l]) & 1UL) << l;
+            diag_[k] *= diag[local_k];
+        }
+    }
+private:
+    std::vector<Complex> diag_;
+    IndexVector idx_;
+};
+
+// Collects gates to be applied at once: general gates are fused into a
+// single matrix, diagonal gates are collected separately and applied after
+// the fused matrix (i.e., they may only be deferred past gates on other
+// qubits, see commutes_with_diagonal()). Diagonal gates are merged into
+// items of at most max_diagonal_qubits qubits, but there may be any number
+// of such items.
 class Fusion{
 public:
     using Index = unsigned;
     using IndexSet = std::set<Index>;
     using IndexVector = std::vector<Index>;
     using Complex = std::complex<double>;
-    using Matrix = std::vector<std::vector<Complex, aligned_allocator<Complex, 64>>>;
+    using Matrix = FlatMatrix<Complex>;
     using ItemVector = std::vector<Item>;
+    using DiagonalItemVector = std::vector<DiagonalItem>;
+
+    static constexpr unsigned max_diagonal_qubits = 12;
+    // diagonal gates with more controls are fused like other gates: their
+    // phases would be tabulated on all controls, while the controlled kernels
+    // only visit the amplitudes with all controls set
+    static constexpr unsigned max_diagonal_controls = 3;
 
-    unsigned num_qubits() {
+    // number of qubits of the fused (non-diagonal) matrix
+    unsigned num_qubits() const {
         return set_.size();
     }
 
+    // number of qubits the fused matrix would have after insert(matrix,
+    // index_list, ctrl_list), without modifying the collected gates: besides
+    // the targets, controls of the new gate which are not shared by the
+    // collected gates (and vice versa) become part of the matrix
+    unsigned num_qubits_if_inserted(IndexVector const& index_list, IndexVector const& ctrl_list) const {
+        IndexVector added;
+        for (auto idx : index_list)
+            if (set_.count(idx) == 0)
+                added.push_back(idx);
+        if (items_.size() > 0){
+            for (auto ctrl : ctrl_list)
+                if (ctrl_set_.count(ctrl) == 0 && set_.count(ctrl) == 0)
+                    added.push_back(ctrl);
+            for (auto ctrl : ctrl_set_)
+                if (std::find(ctrl_list.begin(), ctrl_list.end(), ctrl) == ctrl_list.end())
+                    added.push_back(ctrl);
+        }
+        std::sort(added.begin(), added.end());
+        return set_.size() + (std::unique(added.begin(), added.end()) - added.begin());
+    }
+
     std::size_t size() const {
-        return items_.size();
+        return items_.size() + diagonal_items_.size();
     }
 
+    static bool is_diagonal(Matrix const& matrix){
+        for (std::size_t i = 0; i < matrix.size(); ++i){
+            for (std::size_t j = 0; j < matrix.size(); ++j)
+                if (i != j && matrix[i][j] != 0.)
+                    return false;
+        }
+        return true;
+    }
+
+    // returns true if the (controlled) gate is to be added by insert_diagonal
+    static bool collects_as_diagonal(Matrix const& matrix, IndexVector const& ctrl_list){
+        return ctrl_list.size() <= max_diagonal_controls && is_diagonal(matrix);
+    }
+
+    // returns true if a gate acting on index_list may be executed before the
+    // collected diagonal gates, i.e., if it does not act on any of their qubits
+    // (controls do not matter, as they commute with diagonal gates)
+    bool commutes_with_diagonal(IndexVector const& index_list) const {
+        for (auto idx : index_list)
+            if (diagonal_set_.count(idx) > 0)
+                return false;
+        return true;
+    }
+
+    // adds a (controlled) diagonal gate, which is merged into the item that
+    // grows the least (if it ends up with at most max_diagonal_qubits qubits)
+    void insert_diagonal(Matrix const& matrix, IndexVector const& index_list, IndexVector const& ctrl_list = {}){
+        IndexVector idx(index_list);
+        idx.insert(idx.end(), ctrl_list.begin(), ctrl_list.end());
+        std::sort(idx.begin(), idx.end());
+        idx.erase(std::unique(idx.begin(), idx.end()), idx.end());
+
+        // diagonal of the controlled gate on the qubits idx
+        std::vector<Complex> diag(1UL << idx.size());
+        std::size_t ctrlmask = 0;
+        std::vector<unsigned> bit(index_list.size());
+        for (auto ctrl : ctrl_list)
+            ctrlmask |= 1UL << (std::lower_bound(idx.begin(), idx.end(), ctrl) - idx.begin());
+        for (std::size_t l = 0; l < index_list.size(); ++l)
+            bit[l] = std::lower_bound(idx.begin(), idx.end(), index_list[l]) - idx.begin();
+        for (std::size_t k = 0; k < diag.size(); ++k){
+            if ((k & ctrlmask) != ctrlmask){
+                diag[k] = 1.;
+                continue;
+            }
+            std::size_t local_k = 0;
+            for (std::size_t l = 0; l < index_list.size(); ++l)
+                local_k |= ((k >> bit[l]) & 1UL) << l;
+            diag[k] = matrix[local_k][local_k];
+        }
+
+        for (auto i : idx)
+            diagonal_set_.insert(i);
+
+        DiagonalItem* best = nullptr;
+        IndexVector best_union;
+        for (auto& item : diagonal_items_){
+            IndexVector merged;
+            std::set_union(item.get_indices().begin(), item.get_indices().end(),
+                           idx.begin(), idx.end(), std::back_inserter(merged));
+            if (merged.size() <= max_diagonal_qubits
+                    && (best == nullptr || merged.size() < best_union.size())){
+                best = &item;
+                best_union = std::move(merged);
+            }
+        }
+        if (best == nullptr){
+            diagonal_items_.emplace_back(std::move(diag), idx);
+            return;
+        }
+        if (best_union.size() > best->get_indices().size())
+            best->extend(best_union);
+        best->multiply(diag, idx);
+    }
+
+    DiagonalItemVector const& diagonal_items() const {
+        return diagonal_items_;
+    }
+
+    // adds a (controlled) gate, pass the matrix as an rvalue to avoid copying it
     void insert(Matrix matrix, IndexVector index_list, IndexVector const& ctrl_list = {}){
         for (auto idx : index_list)
             set_.emplace(idx);
 
         handle_controls(matrix, index_list, ctrl_list);
-        Item item(matrix, index_list);
-        items_.push_back(item);
+        items_.emplace_back(std::move(matrix), std::move(index_list));
+    }
+
+    // removes the (non-diagonal) gates of the fused matrix, e.g. after it
+    // has been applied, but keeps the collected diagonal gates
+    void clear_matrix(){
+        set_.clear();
+        items_.clear();
+        ctrl_set_.clear();
+    }
+
+    // removes all collected gates
+    void clear(){
+        set_.clear();
+        items_.clear();
+        ctrl_set_.clear();
+        diagonal_set_.clear();
+        diagonal_items_.clear();
     }
 
+    // computes the product of all (non-diagonal) items on the qubits
+    // index_list (in ascending order), which are controlled by ctrl_list
     void perform_fusion(Matrix& fused_matrix, IndexVector& index_list, IndexVector& ctrl_list){
         for (auto idx : set_)
             index_list.push_back(idx);
 
-        std::size_t N = num_qubits();
-        fused_matrix = Matrix(1UL<<N, std::vector<Complex, aligned_allocator<Complex, 64>>(1UL<<N));
-        auto &M = fused_matrix;
-
-        for (std::size_t i = 0; i < (1UL<<N); ++i)
-            M[i][i] = 1.;
-
-        for (auto& item : items_){
-            auto const& idx = item.get_indices();
-            IndexVector idx2mat(idx.size());
-            for (std::size_t i = 0; i < idx.size(); ++i)
-                idx2mat[i] = ((std::equal_range(index_list.begin(), index_list.end(), idx[i])).first - index_list.begin());
-
-            for (std::size_t k = 0; k < (1UL<<N); ++k){ // loop over big matrix columns
-                // check if column index satisfies control-mask
-                // if not: leave it unchanged
-                std::vector<Complex> oldcol(1UL<<N);
-                for (std::size_t i = 0; i < (1UL<<N); ++i)
-                    oldcol[i] = M[i][k];
-
-                for (std::size_t i = 0; i < (1UL<<N); ++i){
-                    std::size_t local_i = 0;
-                    for (std::size_t l = 0; l < idx.size(); ++l)
-                        local_i |= ((i >> idx2mat[l])&1UL)<<l;
-
-                    Complex res = 0.;
-                    for (std::size_t j = 0; j < (1UL<<idx.size()); ++j){
-                        std::size_t locidx = i;
-                        for (std::size_t l = 0; l < idx.size(); ++l)
-                            if (((j >> l)&1UL) != ((i >> idx2mat[l])&1UL))
-                                locidx ^= (1UL << idx2mat[l]);
-                        res += oldcol[locidx] * item.get_matrix()[local_i][j];
-                    }
-                    M[i][k] = res;
-                }
-            }
-        }
+        fused_matrix = Matrix::identity(1UL << num_qubits());
+        std::vector<Complex, aligned_allocator<Complex, 64>> rows;
+        for (auto& item : items_)
+            apply_item(fused_matrix, item, index_list, rows);
+
         ctrl_list.reserve(ctrl_set_.size());
         for (auto ctrl : ctrl_set_)
             ctrl_list.push_back(ctrl);
     }
 
 private:
+    // multiplies M (acting on the qubits index_list) from the left by the
+    // matrix of the item: for each group of 2^k rows which differ only in the
+    // bits of the item's qubits, the rows are copied to the scratch buffer
+    // `rows` and replaced by their linear combinations (skipping zero
+    // entries, e.g. of controlled gates), one contiguous row at a time
+    static void apply_item(Matrix& M, Item& item, IndexVector const& index_list,
+                           std::vector<Complex, aligned_allocator<Complex, 64>>& rows){
+        auto const& idx = item.get_indices();
+        auto const& G = item.get_matrix();
+        unsigned k = idx.size();
+        std::size_t D = 1UL << k, dim = M.size();
+
+        // row offsets of the group members and sorted bit positions
+        std::vector<unsigned> pos(k);
+        std::vector<std::size_t> off(D, 0);
+        for (unsigned l = 0; l < k; ++l){
+            pos[l] = std::lower_bound(index_list.begin(), index_list.end(), idx[l]) - index_list.begin();
+            for (std::size_t i = 0; i < (1UL << l); ++i)
+                off[i + (1UL << l)] = off[i] + (1UL << pos[l]);
+        }
+        std::sort(pos.begin(), pos.end());
+
+        rows.resize(D * dim);
+        for (std::size_t g = 0; g < (dim >> k); ++g){
+            std::size_t base = insert_zero_bits(g, pos.data(), k);
+            for (std::size_t j = 0; j < D; ++j)
+                std::copy_n(M[base + off[j]], dim, rows.data() + j * dim);
+            for (std::size_t r = 0; r < D; ++r){
+                Complex* out = M[base + off[r]];
+                std::fill_n(out, dim, Complex(0.));
+                for (std::size_t j = 0; j < D; ++j){
+                    if (G[r][j] == 0.)
+                        continue;
+                    // spelled out in real arithmetic such that it vectorizes
+                    double const re = std::real(G[r][j]), im = std::imag(G[r][j]);
+                    double const* in = reinterpret_cast<double const*>(rows.data() + j * dim);
+                    double* o = reinterpret_cast<double*>(out);
+                    for (std::size_t c = 0; c < 2 * dim; c += 2){
+                        o[c] += re * in[c] - im * in[c + 1];
+                        o[c + 1] += re * in[c + 1] + im * in[c];
+                    }
+                }
+            }
+        }
+    }
+
     void add_controls(Matrix &matrix, IndexVector &indexList, IndexVector const& new_ctrls){
         indexList.reserve(indexList.size()+new_ctrls.size());
         indexList.insert(indexList.end(), new_ctrls.begin(), new_ctrls.end());
 
         std::size_t F = (1UL << new_ctrls.size());
-        Matrix newmatrix(F*matrix.size(), std::vector<Complex, aligned_allocator<Complex,64>>(F*matrix.size(), 0.));
+        Matrix newmatrix(F*matrix.size());
 
         std::size_t Offset = newmatrix.size()-matrix.size();
 
@@ -162,6 +359,8 @@ private:
     IndexSet set_;
     ItemVector items_;
     IndexSet ctrl_set_;
+    IndexSet diagonal_set_;
+    DiagonalItemVector diagonal_items_;
 };
 
 #endif
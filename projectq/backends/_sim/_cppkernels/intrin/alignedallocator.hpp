@@ -114,6 +114,38 @@ class aligned_allocator
     }
 };
 
+// Aligned allocator which does not value-initialize elements, i.e., resizing
+// a vector does not touch the new memory before it is actually written to.
+// Only meant for trivially destructible element types (e.g., std::complex).
+template <typename T, unsigned int Alignment>
+class uninitialized_aligned_allocator : public aligned_allocator<T, Alignment>
+{
+ public:
+    template <typename U>
+    struct rebind
+    {
+        typedef uninitialized_aligned_allocator<U, Alignment> other;
+    };
+
+    uninitialized_aligned_allocator() noexcept {}
+    uninitialized_aligned_allocator(uninitialized_aligned_allocator const& other) noexcept
+        : aligned_allocator<T, Alignment>(other)
+    {
+    }
+    template <typename U>
+    uninitialized_aligned_allocator(uninitialized_aligned_allocator<U, Alignment> const&) noexcept
+        : aligned_allocator<T, Alignment>()
+    {
+    }
+
+    using aligned_allocator<T, Alignment>::construct;
+
+    template <typename C>
+    void construct(C*)
+    {
+    }
+};
+
 #if __cplusplus < 201103L
 #undef noexcept
 #endif
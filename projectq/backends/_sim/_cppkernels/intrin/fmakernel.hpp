@@ -0,0 +1,68 @@
+// Copyright 2017 ProjectQ-Framework (www.projectq.ch)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FMA_KERNEL_HPP_
+#define FMA_KERNEL_HPP_
+
+#include <cstddef>
+#include <complex>
+
+// Matrix layout of the kernels which compute S::rows rows of the matrix at
+// once with fused multiply-adds (the single-precision AVX2 and the AVX-512
+// kernels). S describes a register holding S::rows complex numbers of type
+// S::real_type:
+//   S::set1(x)             broadcasts x to all entries
+//   S::set_pair(p)         broadcasts the complex number at p to all rows
+//   S::load(p)             loads an aligned register
+//   S::mul(a, b)           a * b
+//   S::fmadd(a, b, c)      a * b + c
+//   S::store(p, off, v)    stores row l of v to p[off[l]]
+//
+// The entries at mm[2 * L * (r*D + c)] are m[L*r][c], ..., m[L*r + L-1][c]
+// and mmt holds the same entries as (-imag, real), such that the complex
+// products are computed by two fused multiply-adds with the broadcast real
+// and imaginary part of the amplitude. Both have 2 * D * D entries.
+template <std::size_t L, class R, class M>
+void fma_matrix(M const& m, std::size_t D, R* mm, R* mmt)
+{
+    for (std::size_t r = 0; r < D / L; ++r){
+        for (std::size_t c = 0; c < D; ++c){
+            for (std::size_t l = 0; l < L; ++l){
+                std::size_t k = 2 * L * (r * D + c) + 2 * l;
+                mm[k] = R(std::real(m[L * r + l][c]));
+                mm[k + 1] = R(std::imag(m[L * r + l][c]));
+                mmt[k] = -R(std::imag(m[L * r + l][c]));
+                mmt[k + 1] = R(std::real(m[L * r + l][c]));
+            }
+        }
+    }
+}
+
+// Same as fma_matrix, but for a real matrix: the entries of mm are repeated
+// for the real and imaginary part, such that a single multiply-add per entry
+// suffices.
+template <std::size_t L, class R, class M>
+void fma_matrix_real(M const& m, std::size_t D, R* mm)
+{
+    for (std::size_t r = 0; r < D / L; ++r){
+        for (std::size_t c = 0; c < D; ++c){
+            for (std::size_t l = 0; l < L; ++l){
+                std::size_t k = 2 * L * (r * D + c) + 2 * l;
+                mm[k] = mm[k + 1] = R(std::real(m[L * r + l][c]));
+            }
+        }
+    }
+}
+
+#endif
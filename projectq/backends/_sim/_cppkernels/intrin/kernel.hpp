@@ -0,0 +1,287 @@
+// Copyright 2017 ProjectQ-Framework (www.projectq.ch)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef AVX2_KERNEL_HPP_
+#define AVX2_KERNEL_HPP_
+
+#include <cstddef>
+#include <vector>
+#include <complex>
+#include <immintrin.h>
+#include "target.hpp"
+#include "cintrin.hpp"
+#include "fmakernel.hpp"
+#include "alignedallocator.hpp"
+#include "../bitops.hpp"
+#include "../nointrin/kernels.hpp"
+
+// AVX2 kernels: each register holds two complex numbers in double and four
+// in single precision. The matrix is brought into the layout of the kernel
+// once and then shared (read-only) by all threads.
+namespace avx2{
+
+// Applies the matrix to the D amplitudes psi[I + off[.]]. Each entry of mm
+// holds two vertically adjacent matrix entries, i.e., m[2r][c] and m[2r+1][c]
+// are stored at mm[r*D + c], such that a pair of rows is computed at once.
+template <std::size_t D, class V>
+TARGET_AVX2 inline void kernel_core(V &psi, std::size_t I, std::size_t const* off, cintrin<double> const* mm, cintrin<double> const* mmt)
+{
+    __m256d v[D];
+
+    for (std::size_t c = 0; c < D; ++c)
+        v[c] = load2(&psi[I + off[c]]);
+
+    for (std::size_t r = 0; r < D / 2; ++r){
+        auto m = mm + r * D;
+        auto mt = mmt + r * D;
+        __m256d res = mul(v[0], m[0].v_, mt[0].v_);
+        for (std::size_t c = 1; c < D; ++c)
+            res = add(res, mul(v[c], m[c].v_, mt[c].v_));
+        _mm256_storeu2_m128d((double*)&psi[I + off[2 * r + 1]], (double*)&psi[I + off[2 * r]], res);
+    }
+}
+
+// applies the 2^K x 2^K matrix m to the qubits at bit indices ids[0], ...,
+// ids[K-1], where ids[0] corresponds to the least significant bit of the
+// matrix index (e.g. the target of a CNOT), if all bits in ctrlmask are set
+template <unsigned K, class V, class M>
+TARGET_AVX2 void kernel(V &psi, unsigned const* ids, M const& m, std::size_t ctrlmask)
+{
+    constexpr std::size_t D = std::size_t(1) << K;
+    std::size_t n = psi.size();
+
+    std::size_t off[D];
+    off[0] = 0;
+    for (unsigned k = 0; k < K; ++k){
+        for (std::size_t i = 0; i < (std::size_t(1) << k); ++i)
+            off[i + (std::size_t(1) << k)] = off[i] + (std::size_t(1) << ids[k]);
+    }
+
+    // only the index groups with all control bits set are enumerated
+    unsigned pos[8 * sizeof(std::size_t)];
+    unsigned num_pos = sorted_positions(ids, K, ctrlmask, pos);
+
+    std::vector<cintrin<double>, aligned_allocator<cintrin<double>, 64>> mm(D * D / 2), mmt(D * D / 2);
+    __m256d neg = _mm256_setr_pd(1.0, -1.0, 1.0, -1.0);
+    for (std::size_t r = 0; r < D / 2; ++r){
+        for (std::size_t c = 0; c < D; ++c){
+            mm[r * D + c] = load(&m[2 * r][c], &m[2 * r + 1][c]);
+            auto badc = _mm256_permute_pd(mm[r * D + c].v_, 5);
+            mmt[r * D + c] = _mm256_mul_pd(badc, neg);
+        }
+    }
+
+    #pragma omp parallel for schedule(static)
+    for (std::size_t i = 0; i < (n >> num_pos); ++i)
+        kernel_core<D>(psi, insert_zero_bits(i, pos, num_pos) | ctrlmask, off, mm.data(), mmt.data());
+}
+
+// Same as kernel_core, but for a real matrix: each entry of mm holds the
+// entries m[2r][c] and m[2r+1][c], each repeated for the real and imaginary
+// part, such that a single multiplication per entry suffices.
+template <std::size_t D, class V>
+TARGET_AVX2 inline void kernel_core_real(V &psi, std::size_t I, std::size_t const* off, cintrin<double> const* mm)
+{
+    __m256d v[D];
+
+    for (std::size_t c = 0; c < D; ++c)
+        v[c] = load2(&psi[I + off[c]]);
+
+    for (std::size_t r = 0; r < D / 2; ++r){
+        auto m = mm + r * D;
+        __m256d res = _mm256_mul_pd(v[0], m[0].v_);
+        for (std::size_t c = 1; c < D; ++c)
+            res = add(res, _mm256_mul_pd(v[c], m[c].v_));
+        _mm256_storeu2_m128d((double*)&psi[I + off[2 * r + 1]], (double*)&psi[I + off[2 * r]], res);
+    }
+}
+
+// same as kernel, but only the real parts of the entries of m are used
+template <unsigned K, class V, class M>
+TARGET_AVX2 void kernel_real(V &psi, unsigned const* ids, M const& m, std::size_t ctrlmask)
+{
+    constexpr std::size_t D = std::size_t(1) << K;
+    std::size_t n = psi.size();
+
+    std::size_t off[D];
+    off[0] = 0;
+    for (unsigned k = 0; k < K; ++k){
+        for (std::size_t i = 0; i < (std::size_t(1) << k); ++i)
+            off[i + (std::size_t(1) << k)] = off[i] + (std::size_t(1) << ids[k]);
+    }
+
+    // only the index groups with all control bits set are enumerated
+    unsigned pos[8 * sizeof(std::size_t)];
+    unsigned num_pos = sorted_positions(ids, K, ctrlmask, pos);
+
+    std::vector<cintrin<double>, aligned_allocator<cintrin<double>, 64>> mm(D * D / 2);
+    for (std::size_t r = 0; r < D / 2; ++r){
+        for (std::size_t c = 0; c < D; ++c){
+            double a = std::real(m[2 * r][c]), b = std::real(m[2 * r + 1][c]);
+            mm[r * D + c] = _mm256_setr_pd(a, a, b, b);
+        }
+    }
+
+    #pragma omp parallel for schedule(static)
+    for (std::size_t i = 0; i < (n >> num_pos); ++i)
+        kernel_core_real<D>(psi, insert_zero_bits(i, pos, num_pos) | ctrlmask, off, mm.data());
+}
+
+// register of four complex floats (see fmakernel.hpp)
+struct simd_float{
+    using real_type = float;
+    using reg = __m256;
+    static constexpr std::size_t rows = 4;
+
+    TARGET_AVX2 static reg set1(float x){ return _mm256_set1_ps(x); }
+    TARGET_AVX2 static reg set_pair(float const* p){ return _mm256_castpd_ps(_mm256_broadcast_sd((double const*)p)); }
+    TARGET_AVX2 static reg load(float const* p){ return _mm256_load_ps(p); }
+    TARGET_AVX2 static reg mul(reg a, reg b){ return _mm256_mul_ps(a, b); }
+    TARGET_AVX2 static reg fmadd(reg a, reg b, reg c){ return _mm256_fmadd_ps(a, b, c); }
+    TARGET_AVX2 static void store(std::complex<float>* p, std::size_t const* off, reg v){
+        __m128 lo = _mm256_castps256_ps128(v), hi = _mm256_extractf128_ps(v, 1);
+        _mm_storel_pi((__m64*)(p + off[0]), lo);
+        _mm_storeh_pi((__m64*)(p + off[1]), lo);
+        _mm_storel_pi((__m64*)(p + off[2]), hi);
+        _mm_storeh_pi((__m64*)(p + off[3]), hi);
+    }
+};
+
+// Applies the matrix to the D amplitudes psi[I + off[.]], S::rows rows at a
+// time (see fmakernel.hpp for S and the layout of mm and mmt).
+template <class S, std::size_t D, class V>
+TARGET_AVX2 inline void fma_kernel_core(V &psi, std::size_t I, std::size_t const* off,
+                                        typename S::real_type const* mm, typename S::real_type const* mmt)
+{
+    using R = typename S::real_type;
+    constexpr std::size_t L = S::rows;
+    typename S::reg re[D], im[D];
+
+    for (std::size_t c = 0; c < D; ++c){
+        R const* p = (R const*)&psi[I + off[c]];
+        re[c] = S::set1(p[0]);
+        im[c] = S::set1(p[1]);
+    }
+
+    for (std::size_t r = 0; r < D / L; ++r){
+        R const* m = mm + 2 * L * r * D;
+        R const* mt = mmt + 2 * L * r * D;
+        auto res = S::mul(re[0], S::load(m));
+        res = S::fmadd(im[0], S::load(mt), res);
+        for (std::size_t c = 1; c < D; ++c){
+            res = S::fmadd(re[c], S::load(m + 2 * L * c), res);
+            res = S::fmadd(im[c], S::load(mt + 2 * L * c), res);
+        }
+        S::store(&psi[I], off + L * r, res);
+    }
+}
+
+// applies the 2^K x 2^K matrix m (2^K >= S::rows) to the qubits at bit
+// indices ids[0], ..., ids[K-1], where ids[0] corresponds to the least
+// significant bit of the matrix index, if all bits in ctrlmask are set
+template <class S, unsigned K, class V, class M>
+TARGET_AVX2 void fma_kernel(V &psi, unsigned const* ids, M const& m, std::size_t ctrlmask)
+{
+    using R = typename S::real_type;
+    constexpr std::size_t D = std::size_t(1) << K;
+    std::size_t n = psi.size();
+
+    std::size_t off[D];
+    off[0] = 0;
+    for (unsigned k = 0; k < K; ++k){
+        for (std::size_t i = 0; i < (std::size_t(1) << k); ++i)
+            off[i + (std::size_t(1) << k)] = off[i] + (std::size_t(1) << ids[k]);
+    }
+
+    // only the index groups with all control bits set are enumerated
+    unsigned pos[8 * sizeof(std::size_t)];
+    unsigned num_pos = sorted_positions(ids, K, ctrlmask, pos);
+
+    std::vector<R, aligned_allocator<R, 64>> mm(2 * D * D), mmt(2 * D * D);
+    fma_matrix<S::rows>(m, D, mm.data(), mmt.data());
+
+    #pragma omp parallel for schedule(static)
+    for (std::size_t i = 0; i < (n >> num_pos); ++i)
+        fma_kernel_core<S, D>(psi, insert_zero_bits(i, pos, num_pos) | ctrlmask, off, mm.data(), mmt.data());
+}
+
+// Same as fma_kernel_core, but for a real matrix (see fma_matrix_real).
+template <class S, std::size_t D, class V>
+TARGET_AVX2 inline void fma_kernel_core_real(V &psi, std::size_t I, std::size_t const* off,
+                                             typename S::real_type const* mm)
+{
+    using R = typename S::real_type;
+    constexpr std::size_t L = S::rows;
+    typename S::reg v[D];
+
+    for (std::size_t c = 0; c < D; ++c)
+        v[c] = S::set_pair((R const*)&psi[I + off[c]]);
+
+    for (std::size_t r = 0; r < D / L; ++r){
+        R const* m = mm + 2 * L * r * D;
+        auto res = S::mul(v[0], S::load(m));
+        for (std::size_t c = 1; c < D; ++c)
+            res = S::fmadd(v[c], S::load(m + 2 * L * c), res);
+        S::store(&psi[I], off + L * r, res);
+    }
+}
+
+// same as fma_kernel, but only the real parts of the entries of m are used
+template <class S, unsigned K, class V, class M>
+TARGET_AVX2 void fma_kernel_real(V &psi, unsigned const* ids, M const& m, std::size_t ctrlmask)
+{
+    using R = typename S::real_type;
+    constexpr std::size_t D = std::size_t(1) << K;
+    std::size_t n = psi.size();
+
+    std::size_t off[D];
+    off[0] = 0;
+    for (unsigned k = 0; k < K; ++k){
+        for (std::size_t i = 0; i < (std::size_t(1) << k); ++i)
+            off[i + (std::size_t(1) << k)] = off[i] + (std::size_t(1) << ids[k]);
+    }
+
+    // only the index groups with all control bits set are enumerated
+    unsigned pos[8 * sizeof(std::size_t)];
+    unsigned num_pos = sorted_positions(ids, K, ctrlmask, pos);
+
+    std::vector<R, aligned_allocator<R, 64>> mm(2 * D * D);
+    fma_matrix_real<S::rows>(m, D, mm.data());
+
+    #pragma omp parallel for schedule(static)
+    for (std::size_t i = 0; i < (n >> num_pos); ++i)
+        fma_kernel_core_real<S, D>(psi, insert_zero_bits(i, pos, num_pos) | ctrlmask, off, mm.data());
+}
+
+// single-precision state vectors: four rows of the matrix are computed at
+// once (gates on a single qubit use the scalar kernels)
+template <unsigned K, class A, class M>
+TARGET_AVX2 void kernel(std::vector<std::complex<float>, A> &psi, unsigned const* ids, M const& m, std::size_t ctrlmask)
+{
+    if (K < 2)
+        return scalar::kernel<K>(psi, ids, m, ctrlmask);
+    fma_kernel<simd_float, K>(psi, ids, m, ctrlmask);
+}
+
+template <unsigned K, class A, class M>
+TARGET_AVX2 void kernel_real(std::vector<std::complex<float>, A> &psi, unsigned const* ids, M const& m, std::size_t ctrlmask)
+{
+    if (K < 2)
+        return scalar::kernel_real<K>(psi, ids, m, ctrlmask);
+    fma_kernel_real<simd_float, K>(psi, ids, m, ctrlmask);
+}
+
+}
+
+#endif
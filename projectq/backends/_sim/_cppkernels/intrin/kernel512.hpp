@@ -0,0 +1,231 @@
+// Copyright 2017 ProjectQ-Framework (www.projectq.ch)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef AVX512_KERNEL_HPP_
+#define AVX512_KERNEL_HPP_
+
+#include <cstddef>
+#include <vector>
+#include <complex>
+#include <immintrin.h>
+#include "target.hpp"
+#include "fmakernel.hpp"
+#include "kernel.hpp"
+#include "alignedallocator.hpp"
+#include "../bitops.hpp"
+
+// AVX-512 kernels: each register holds four complex numbers in double and
+// eight in single precision, i.e., four (eight) rows of the matrix are
+// computed at once (gates on fewer qubits use the AVX2 kernels).
+namespace avx512{
+
+// The zero-masked forms (with all elements selected) of the broadcasts and
+// extracts compile to the same instructions as the plain ones and casts, but
+// the latter pass an undefined register which GCC reports as uninitialized.
+
+// register of four complex doubles (see fmakernel.hpp)
+struct simd_double{
+    using real_type = double;
+    using reg = __m512d;
+    static constexpr std::size_t rows = 4;
+
+    TARGET_AVX512 static reg set1(double x){ return _mm512_set1_pd(x); }
+    TARGET_AVX512 static reg set_pair(double const* p){
+        return _mm512_castps_pd(_mm512_maskz_broadcast_f32x4(0xFFFF, _mm_castpd_ps(_mm_loadu_pd(p))));
+    }
+    TARGET_AVX512 static reg load(double const* p){ return _mm512_load_pd(p); }
+    TARGET_AVX512 static reg mul(reg a, reg b){ return _mm512_mul_pd(a, b); }
+    TARGET_AVX512 static reg fmadd(reg a, reg b, reg c){ return _mm512_fmadd_pd(a, b, c); }
+    TARGET_AVX512 static void store(std::complex<double>* p, std::size_t const* off, reg v){
+        __m256d lo = _mm512_maskz_extractf64x4_pd(0xFF, v, 0);
+        __m256d hi = _mm512_maskz_extractf64x4_pd(0xFF, v, 1);
+        _mm_storeu_pd((double*)(p + off[0]), _mm256_castpd256_pd128(lo));
+        _mm_storeu_pd((double*)(p + off[1]), _mm256_extractf128_pd(lo, 1));
+        _mm_storeu_pd((double*)(p + off[2]), _mm256_castpd256_pd128(hi));
+        _mm_storeu_pd((double*)(p + off[3]), _mm256_extractf128_pd(hi, 1));
+    }
+};
+
+// register of eight complex floats (see fmakernel.hpp)
+struct simd_float{
+    using real_type = float;
+    using reg = __m512;
+    static constexpr std::size_t rows = 8;
+
+    TARGET_AVX512 static reg set1(float x){ return _mm512_set1_ps(x); }
+    TARGET_AVX512 static reg set_pair(float const* p){
+        return _mm512_castpd_ps(_mm512_maskz_broadcastsd_pd(0xFF, _mm_load_sd((double const*)p)));
+    }
+    TARGET_AVX512 static reg load(float const* p){ return _mm512_load_ps(p); }
+    TARGET_AVX512 static reg mul(reg a, reg b){ return _mm512_mul_ps(a, b); }
+    TARGET_AVX512 static reg fmadd(reg a, reg b, reg c){ return _mm512_fmadd_ps(a, b, c); }
+    TARGET_AVX512 static void store(std::complex<float>* p, std::size_t const* off, reg v){
+        __m128 q0 = _mm512_maskz_extractf32x4_ps(0xF, v, 0), q1 = _mm512_maskz_extractf32x4_ps(0xF, v, 1);
+        __m128 q2 = _mm512_maskz_extractf32x4_ps(0xF, v, 2), q3 = _mm512_maskz_extractf32x4_ps(0xF, v, 3);
+        _mm_storel_pi((__m64*)(p + off[0]), q0);
+        _mm_storeh_pi((__m64*)(p + off[1]), q0);
+        _mm_storel_pi((__m64*)(p + off[2]), q1);
+        _mm_storeh_pi((__m64*)(p + off[3]), q1);
+        _mm_storel_pi((__m64*)(p + off[4]), q2);
+        _mm_storeh_pi((__m64*)(p + off[5]), q2);
+        _mm_storel_pi((__m64*)(p + off[6]), q3);
+        _mm_storeh_pi((__m64*)(p + off[7]), q3);
+    }
+};
+
+// Applies the matrix to the D amplitudes psi[I + off[.]], S::rows rows at a
+// time (see fmakernel.hpp for S and the layout of mm and mmt).
+template <class S, std::size_t D, class V>
+TARGET_AVX512 inline void fma_kernel_core(V &psi, std::size_t I, std::size_t const* off,
+                                          typename S::real_type const* mm, typename S::real_type const* mmt)
+{
+    using R = typename S::real_type;
+    constexpr std::size_t L = S::rows;
+    typename S::reg re[D], im[D];
+
+    for (std::size_t c = 0; c < D; ++c){
+        R const* p = (R const*)&psi[I + off[c]];
+        re[c] = S::set1(p[0]);
+        im[c] = S::set1(p[1]);
+    }
+
+    for (std::size_t r = 0; r < D / L; ++r){
+        R const* m = mm + 2 * L * r * D;
+        R const* mt = mmt + 2 * L * r * D;
+        auto res = S::mul(re[0], S::load(m));
+        res = S::fmadd(im[0], S::load(mt), res);
+        for (std::size_t c = 1; c < D; ++c){
+            res = S::fmadd(re[c], S::load(m + 2 * L * c), res);
+            res = S::fmadd(im[c], S::load(mt + 2 * L * c), res);
+        }
+        S::store(&psi[I], off + L * r, res);
+    }
+}
+
+// applies the 2^K x 2^K matrix m (2^K >= S::rows) to the qubits at bit
+// indices ids[0], ..., ids[K-1], where ids[0] corresponds to the least
+// significant bit of the matrix index, if all bits in ctrlmask are set
+template <class S, unsigned K, class V, class M>
+TARGET_AVX512 void fma_kernel(V &psi, unsigned const* ids, M const& m, std::size_t ctrlmask)
+{
+    using R = typename S::real_type;
+    constexpr std::size_t D = std::size_t(1) << K;
+    std::size_t n = psi.size();
+
+    std::size_t off[D];
+    off[0] = 0;
+    for (unsigned k = 0; k < K; ++k){
+        for (std::size_t i = 0; i < (std::size_t(1) << k); ++i)
+            off[i + (std::size_t(1) << k)] = off[i] + (std::size_t(1) << ids[k]);
+    }
+
+    // only the index groups with all control bits set are enumerated
+    unsigned pos[8 * sizeof(std::size_t)];
+    unsigned num_pos = sorted_positions(ids, K, ctrlmask, pos);
+
+    std::vector<R, aligned_allocator<R, 64>> mm(2 * D * D), mmt(2 * D * D);
+    fma_matrix<S::rows>(m, D, mm.data(), mmt.data());
+
+    #pragma omp parallel for schedule(static)
+    for (std::size_t i = 0; i < (n >> num_pos); ++i)
+        fma_kernel_core<S, D>(psi, insert_zero_bits(i, pos, num_pos) | ctrlmask, off, mm.data(), mmt.data());
+}
+
+// Same as fma_kernel_core, but for a real matrix (see fma_matrix_real).
+template <class S, std::size_t D, class V>
+TARGET_AVX512 inline void fma_kernel_core_real(V &psi, std::size_t I, std::size_t const* off,
+                                               typename S::real_type const* mm)
+{
+    using R = typename S::real_type;
+    constexpr std::size_t L = S::rows;
+    typename S::reg v[D];
+
+    for (std::size_t c = 0; c < D; ++c)
+        v[c] = S::set_pair((R const*)&psi[I + off[c]]);
+
+    for (std::size_t r = 0; r < D / L; ++r){
+        R const* m = mm + 2 * L * r * D;
+        auto res = S::mul(v[0], S::load(m));
+        for (std::size_t c = 1; c < D; ++c)
+            res = S::fmadd(v[c], S::load(m + 2 * L * c), res);
+        S::store(&psi[I], off + L * r, res);
+    }
+}
+
+// same as fma_kernel, but only the real parts of the entries of m are used
+template <class S, unsigned K, class V, class M>
+TARGET_AVX512 void fma_kernel_real(V &psi, unsigned const* ids, M const& m, std::size_t ctrlmask)
+{
+    using R = typename S::real_type;
+    constexpr std::size_t D = std::size_t(1) << K;
+    std::size_t n = psi.size();
+
+    std::size_t off[D];
+    off[0] = 0;
+    for (unsigned k = 0; k < K; ++k){
+        for (std::size_t i = 0; i < (std::size_t(1) << k); ++i)
+            off[i + (std::size_t(1) << k)] = off[i] + (std::size_t(1) << ids[k]);
+    }
+
+    // only the index groups with all control bits set are enumerated
+    unsigned pos[8 * sizeof(std::size_t)];
+    unsigned num_pos = sorted_positions(ids, K, ctrlmask, pos);
+
+    std::vector<R, aligned_allocator<R, 64>> mm(2 * D * D);
+    fma_matrix_real<S::rows>(m, D, mm.data());
+
+    #pragma omp parallel for schedule(static)
+    for (std::size_t i = 0; i < (n >> num_pos); ++i)
+        fma_kernel_core_real<S, D>(psi, insert_zero_bits(i, pos, num_pos) | ctrlmask, off, mm.data());
+}
+
+// applies the 2^K x 2^K matrix m to the qubits at bit indices ids[0], ...,
+// ids[K-1], where ids[0] corresponds to the least significant bit of the
+// matrix index (e.g. the target of a CNOT), if all bits in ctrlmask are set
+template <unsigned K, class V, class M>
+TARGET_AVX512 void kernel(V &psi, unsigned const* ids, M const& m, std::size_t ctrlmask)
+{
+    if (K < 2)
+        return avx2::kernel<K>(psi, ids, m, ctrlmask);
+    fma_kernel<simd_double, K>(psi, ids, m, ctrlmask);
+}
+
+template <unsigned K, class A, class M>
+TARGET_AVX512 void kernel(std::vector<std::complex<float>, A> &psi, unsigned const* ids, M const& m, std::size_t ctrlmask)
+{
+    if (K < 3)
+        return avx2::kernel<K>(psi, ids, m, ctrlmask);
+    fma_kernel<simd_float, K>(psi, ids, m, ctrlmask);
+}
+
+// same as kernel, but only the real parts of the entries of m are used
+template <unsigned K, class V, class M>
+TARGET_AVX512 void kernel_real(V &psi, unsigned const* ids, M const& m, std::size_t ctrlmask)
+{
+    if (K < 2)
+        return avx2::kernel_real<K>(psi, ids, m, ctrlmask);
+    fma_kernel_real<simd_double, K>(psi, ids, m, ctrlmask);
+}
+
+template <unsigned K, class A, class M>
+TARGET_AVX512 void kernel_real(std::vector<std::complex<float>, A> &psi, unsigned const* ids, M const& m, std::size_t ctrlmask)
+{
+    if (K < 3)
+        return avx2::kernel_real<K>(psi, ids, m, ctrlmask);
+    fma_kernel_real<simd_float, K>(psi, ids, m, ctrlmask);
+}
+
+}
+
+#endif
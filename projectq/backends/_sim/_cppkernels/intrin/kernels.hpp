@@ -18,18 +18,45 @@
 #include <complex>
 #include <functional>
 #include <algorithm>
-#include "cintrin.hpp"
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
 #include "alignedallocator.hpp"
+#include "../nointrin/kernels.hpp"
 
-#define LOOP_COLLAPSE1 2
-#define LOOP_COLLAPSE2 3
-#define LOOP_COLLAPSE3 4
-#define LOOP_COLLAPSE4 5
-#define LOOP_COLLAPSE5 6
-
-#include "kernel1.hpp"
-#include "kernel2.hpp"
-#include "kernel3.hpp"
-#include "kernel4.hpp"
-#include "kernel5.hpp"
+// The AVX2 and AVX-512 kernels are compiled for their instruction sets
+// independently of the flags of the translation unit (see target.hpp), such
+// that the simulator can pick the best kernels supported by the CPU at
+// runtime (the scalar kernels from nointrin/ serve as fallback). Both come in
+// double and single precision.
+#include "kernel.hpp"
+#include "kernel512.hpp"
 
+// Returns the best instruction set supported by the CPU (and the operating
+// system): 2 for AVX-512, 1 for AVX2 (with FMA) and 0 if neither is available.
+inline unsigned cpu_kernel_level(){
+#if defined(__GNUC__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+        return 2;
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+        return 1;
+#elif defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+        return 0;
+    __cpuid(info, 1);
+    bool fma = (info[2] >> 12) & 1, osxsave = (info[2] >> 27) & 1;
+    if (!osxsave)
+        return 0;
+    unsigned long long xcr0 = _xgetbv(0);
+    __cpuidex(info, 7, 0);
+    if ((xcr0 & 0xe6) == 0xe6 && ((info[1] >> 16) & 1))
+        return 2;
+    if ((xcr0 & 0x6) == 0x6 && ((info[1] >> 5) & 1) && fma)
+        return 1;
+#endif
+    return 0;
+}
@@ -0,0 +1,30 @@
+// Copyright 2017 ProjectQ-Framework (www.projectq.ch)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INTRIN_TARGET_HPP_
+#define INTRIN_TARGET_HPP_
+
+// Compiles a function for the given instruction set independently of the
+// flags of the translation unit, such that the AVX2 and AVX-512 kernels can
+// be built into one binary and be selected at runtime. MSVC accepts the
+// intrinsics in any function.
+#if defined(__GNUC__) || defined(__clang__)
+#define TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define TARGET_AVX512 __attribute__((target("avx512f,avx2,fma")))
+#else
+#define TARGET_AVX2
+#define TARGET_AVX512
+#endif
+
+#endif
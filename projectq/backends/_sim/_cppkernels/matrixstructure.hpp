@@ -0,0 +1,115 @@
+// Copyright 2017 ProjectQ-Framework (www.projectq.ch)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MATRIX_STRUCTURE_HPP_
+#define MATRIX_STRUCTURE_HPP_
+
+#include <vector>
+#include <complex>
+#include <algorithm>
+#include "bitops.hpp"
+
+// Returns true if all entries of the matrix m are real.
+template <class M>
+bool is_real(M const& m){
+    for (std::size_t r = 0; r < m.size(); ++r){
+        for (std::size_t c = 0; c < m.size(); ++c)
+            if (std::imag(m[r][c]) != 0.)
+                return false;
+    }
+    return true;
+}
+
+// Returns true if each row of the square matrix m has exactly one non-zero
+// entry in a distinct column, i.e., if m is a permutation matrix with phases.
+template <class M>
+bool is_monomial(M const& m){
+    std::vector<bool> used(m.size(), false);
+    for (std::size_t r = 0; r < m.size(); ++r){
+        std::size_t nonzero = m.size();
+        for (std::size_t c = 0; c < m.size(); ++c){
+            if (m[r][c] != 0.){
+                if (nonzero != m.size())
+                    return false;
+                nonzero = c;
+            }
+        }
+        if (nonzero == m.size() || used[nonzero])
+            return false;
+        used[nonzero] = true;
+    }
+    return true;
+}
+
+// Applies the monomial matrix m (see is_monomial) to the qubits at bit
+// indices ids[0], ..., ids[K-1] (ids[0] corresponds to the least significant
+// bit of the matrix index) if all bits in ctrlmask are set. Rows which map an
+// amplitude onto itself are skipped, and if all non-zero entries are 1, the
+// amplitudes are only moved.
+template <unsigned K, class V, class M>
+void kernel_monomial(V &psi, unsigned const* ids, M const& m, std::size_t ctrlmask)
+{
+    using Complex = typename V::value_type;
+    constexpr std::size_t D = std::size_t(1) << K;
+    std::size_t n = psi.size();
+
+    std::size_t off[D];
+    off[0] = 0;
+    for (unsigned k = 0; k < K; ++k){
+        for (std::size_t i = 0; i < (std::size_t(1) << k); ++i)
+            off[i + (std::size_t(1) << k)] = off[i] + (std::size_t(1) << ids[k]);
+    }
+
+    // only the index groups with all control bits set are enumerated
+    unsigned pos[8 * sizeof(std::size_t)];
+    unsigned num_pos = sorted_positions(ids, K, ctrlmask, pos);
+
+    // offsets of the amplitudes which change: dst[j] = val[j] * src[j]
+    std::size_t src[D], dst[D];
+    Complex val[D];
+    std::size_t num = 0;
+    bool permutation = true;
+    for (std::size_t r = 0; r < D; ++r){
+        std::size_t c = 0;
+        while (m[r][c] == 0.)
+            ++c;
+        if (c == r && m[r][c] == 1.)
+            continue;
+        src[num] = off[c];
+        dst[num] = off[r];
+        val[num] = m[r][c];
+        permutation = permutation && val[num] == Complex(1);
+        ++num;
+    }
+    if (num == 0)
+        return;
+
+    #pragma omp parallel for schedule(static)
+    for (std::size_t i = 0; i < (n >> num_pos); ++i){
+        std::size_t I = insert_zero_bits(i, pos, num_pos) | ctrlmask;
+        Complex v[D];
+        for (std::size_t j = 0; j < num; ++j)
+            v[j] = psi[I + src[j]];
+        if (permutation){
+            for (std::size_t j = 0; j < num; ++j)
+                psi[I + dst[j]] = v[j];
+        }
+        else{
+            for (std::size_t j = 0; j < num; ++j)
+                psi[I + dst[j]] = val[j] * v[j];
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,133 @@
+// Copyright 2017 ProjectQ-Framework (www.projectq.ch)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SCALAR_KERNEL_HPP_
+#define SCALAR_KERNEL_HPP_
+
+#include <cstddef>
+#include <vector>
+#include <complex>
+#include "../bitops.hpp"
+
+// portable kernels, which serve as fallback if the CPU (or the build) does
+// not support the AVX2 or AVX-512 kernels
+namespace scalar{
+
+template <class T>
+inline T add(T a, T b){ return a+b; }
+
+template <class T>
+inline T mul(T a, T b){ return a*b; }
+
+// Applies the matrix (stored row by row in m) to the D amplitudes
+// psi[I + off[.]].
+template <std::size_t D, class V, class T>
+inline void kernel_core(V &psi, std::size_t I, std::size_t const* off, std::complex<T> const* m)
+{
+    std::complex<T> v[D];
+
+    for (std::size_t c = 0; c < D; ++c)
+        v[c] = psi[I + off[c]];
+
+    for (std::size_t r = 0; r < D; ++r){
+        std::complex<T> res = mul(v[0], m[r * D]);
+        for (std::size_t c = 1; c < D; ++c)
+            res = add(res, mul(v[c], m[r * D + c]));
+        psi[I + off[r]] = res;
+    }
+}
+
+// applies the 2^K x 2^K matrix m to the qubits at bit indices ids[0], ...,
+// ids[K-1], where ids[0] corresponds to the least significant bit of the
+// matrix index (e.g. the target of a CNOT), if all bits in ctrlmask are set
+template <unsigned K, class V, class M>
+void kernel(V &psi, unsigned const* ids, M const& m, std::size_t ctrlmask)
+{
+    constexpr std::size_t D = std::size_t(1) << K;
+    std::size_t n = psi.size();
+
+    std::size_t off[D];
+    off[0] = 0;
+    for (unsigned k = 0; k < K; ++k){
+        for (std::size_t i = 0; i < (std::size_t(1) << k); ++i)
+            off[i + (std::size_t(1) << k)] = off[i] + (std::size_t(1) << ids[k]);
+    }
+
+    // only the index groups with all control bits set are enumerated
+    unsigned pos[8 * sizeof(std::size_t)];
+    unsigned num_pos = sorted_positions(ids, K, ctrlmask, pos);
+
+    // the matrix is converted to the precision of the state vector
+    using Complex = typename V::value_type;
+    std::vector<Complex> mc(D * D);
+    for (std::size_t r = 0; r < D; ++r){
+        for (std::size_t c = 0; c < D; ++c)
+            mc[r * D + c] = Complex(m[r][c]);
+    }
+
+    #pragma omp parallel for schedule(static)
+    for (std::size_t i = 0; i < (n >> num_pos); ++i)
+        kernel_core<D>(psi, insert_zero_bits(i, pos, num_pos) | ctrlmask, off, mc.data());
+}
+
+// Same as kernel_core, but for a real matrix (stored row by row in m).
+template <std::size_t D, class V, class T>
+inline void kernel_core_real(V &psi, std::size_t I, std::size_t const* off, T const* m)
+{
+    std::complex<T> v[D];
+
+    for (std::size_t c = 0; c < D; ++c)
+        v[c] = psi[I + off[c]];
+
+    for (std::size_t r = 0; r < D; ++r){
+        std::complex<T> res = v[0] * m[r * D];
+        for (std::size_t c = 1; c < D; ++c)
+            res += v[c] * m[r * D + c];
+        psi[I + off[r]] = res;
+    }
+}
+
+// same as kernel, but only the real parts of the entries of m are used
+template <unsigned K, class V, class M>
+void kernel_real(V &psi, unsigned const* ids, M const& m, std::size_t ctrlmask)
+{
+    constexpr std::size_t D = std::size_t(1) << K;
+    std::size_t n = psi.size();
+
+    std::size_t off[D];
+    off[0] = 0;
+    for (unsigned k = 0; k < K; ++k){
+        for (std::size_t i = 0; i < (std::size_t(1) << k); ++i)
+            off[i + (std::size_t(1) << k)] = off[i] + (std::size_t(1) << ids[k]);
+    }
+
+    // only the index groups with all control bits set are enumerated
+    unsigned pos[8 * sizeof(std::size_t)];
+    unsigned num_pos = sorted_positions(ids, K, ctrlmask, pos);
+
+    using Real = typename V::value_type::value_type;
+    std::vector<Real> mr(D * D);
+    for (std::size_t r = 0; r < D; ++r){
+        for (std::size_t c = 0; c < D; ++c)
+            mr[r * D + c] = Real(std::real(m[r][c]));
+    }
+
+    #pragma omp parallel for schedule(static)
+    for (std::size_t i = 0; i < (n >> num_pos); ++i)
+        kernel_core_real<D>(psi, insert_zero_bits(i, pos, num_pos) | ctrlmask, off, mr.data());
+}
+
+}
+
+#endif
@@ -12,6 +12,9 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#ifndef NOINTRIN_KERNELS_HPP_
+#define NOINTRIN_KERNELS_HPP_
+
 #include <cmath>
 #include <cstdlib>
 #include <vector>
@@ -19,22 +22,7 @@
 #include <functional>
 #include <algorithm>
 #include "../intrin/alignedallocator.hpp"
+#include "../bitops.hpp"
+#include "kernel.hpp"
 
-template <class T>
-inline T add(T a, T b){ return a+b; }
-
-template <class T>
-inline T mul(T a, T b){ return a*b; }
-
-
-#define LOOP_COLLAPSE1 2
-#define LOOP_COLLAPSE2 3
-#define LOOP_COLLAPSE3 4
-#define LOOP_COLLAPSE4 5
-#define LOOP_COLLAPSE5 6
-
-#include "kernel1.hpp"
-#include "kernel2.hpp"
-#include "kernel3.hpp"
-#include "kernel4.hpp"
-#include "kernel5.hpp"
+#endif
@@ -0,0 +1,124 @@
+// Copyright 2017 ProjectQ-Framework (www.projectq.ch)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GATE_SCHEDULER_HPP_
+#define GATE_SCHEDULER_HPP_
+
+#include <vector>
+#include <algorithm>
+#include <utility>
+#include "fusion.hpp"
+
+// Window of pending gates together with their dependencies: a gate depends on
+// an earlier gate unless the two commute. This is the case if no qubit on
+// which one of them acts non-diagonally (i.e., a target of a non-diagonal
+// gate) is used by the other one: controls and the qubits of diagonal gates
+// only select blocks, which the other gate leaves invariant.
+class GateScheduler{
+public:
+    using Index = Fusion::Index;
+    using IndexVector = Fusion::IndexVector;
+    using Matrix = Fusion::Matrix;
+
+    struct Gate{
+        Matrix matrix;
+        IndexVector ids, ctrl;
+        bool diagonal;       // collected by Fusion::insert_diagonal
+        IndexVector qubits;  // targets and controls (sorted)
+        IndexVector changed; // targets of non-diagonal gates (sorted)
+        unsigned num_deps;   // number of pending gates this one depends on
+        std::vector<std::size_t> successors;
+        bool done;
+    };
+
+    std::size_t size() const {
+        return gates_.size();
+    }
+
+    void push(Matrix matrix, IndexVector const& ids, IndexVector const& ctrl){
+        Gate gate;
+        gate.diagonal = Fusion::collects_as_diagonal(matrix, ctrl);
+        gate.matrix = std::move(matrix);
+        gate.ids = ids;
+        gate.ctrl = ctrl;
+        gate.qubits = ids;
+        gate.qubits.insert(gate.qubits.end(), ctrl.begin(), ctrl.end());
+        std::sort(gate.qubits.begin(), gate.qubits.end());
+        if (!gate.diagonal){
+            gate.changed = ids;
+            std::sort(gate.changed.begin(), gate.changed.end());
+        }
+        gate.num_deps = 0;
+        gate.done = false;
+        for (auto& other : gates_){
+            if (!commute(other, gate)){
+                other.successors.push_back(gates_.size());
+                gate.num_deps++;
+            }
+        }
+        gates_.push_back(std::move(gate));
+    }
+
+    // Emits all gates in an order respecting the dependencies: the gates
+    // whose dependencies have been emitted are offered to try_emit(gate) in
+    // the order of arrival, which moves the gate into the current cluster
+    // and returns true if it fits. Once no such gate fits anymore, the
+    // cluster is closed by calling close_cluster(), and the next cluster is
+    // formed.
+    template <class TryEmit, class CloseCluster>
+    void drain(TryEmit try_emit, CloseCluster close_cluster){
+        std::size_t remaining = gates_.size();
+        while (remaining > 0){
+            bool progress = true;
+            while (progress){
+                progress = false;
+                for (std::size_t i = 0; i < gates_.size(); ++i){
+                    Gate& gate = gates_[i];
+                    if (gate.done || gate.num_deps > 0 || !try_emit(gate))
+                        continue;
+                    gate.done = true;
+                    for (auto s : gate.successors)
+                        gates_[s].num_deps--;
+                    --remaining;
+                    progress = true;
+                }
+            }
+            if (remaining > 0)
+                close_cluster();
+        }
+        gates_.clear();
+    }
+
+private:
+    static bool intersect(IndexVector const& a, IndexVector const& b){
+        auto i = a.begin(), j = b.begin();
+        while (i != a.end() && j != b.end()){
+            if (*i == *j)
+                return true;
+            if (*i < *j)
+                ++i;
+            else
+                ++j;
+        }
+        return false;
+    }
+
+    static bool commute(Gate const& a, Gate const& b){
+        return !intersect(a.changed, b.qubits) && !intersect(b.changed, a.qubits);
+    }
+
+    std::vector<Gate> gates_;
+};
+
+#endif
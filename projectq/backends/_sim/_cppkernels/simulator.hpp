@@ -18,63 +18,121 @@
 #include <vector>
 #include <complex>
 
-#if defined(NOINTRIN) || !defined(INTRIN)
 #include "nointrin/kernels.hpp"
-#else
+#if defined(INTRIN) && !defined(NOINTRIN)
 #include "intrin/kernels.hpp"
 #endif
 
 #include "intrin/alignedallocator.hpp"
 #include "fusion.hpp"
+#include "bufferpool.hpp"
+#include "bitops.hpp"
+#include "matrixstructure.hpp"
+#include "scheduler.hpp"
 #include <map>
 #include <cassert>
 #include <algorithm>
 #include <tuple>
+#include <memory>
 #include <random>
 #include <functional>
+#include <numeric>
+#include <cstdint>
+#include <stdexcept>
+#include <atomic>
+#include <string>
+#include <chrono>
 
 
-class Simulator{
+// State vector simulator computing in the floating-point type T (double or
+// float). The gates are fused in double precision (see Fusion) and only
+// converted to T by the kernels.
+template <class T>
+class SimulatorT{
 public:
-    using calc_type = double;
+    using calc_type = T;
     using complex_type = std::complex<calc_type>;
-    using StateVector = std::vector<complex_type, aligned_allocator<complex_type,512>>;
+    using StateVector = std::vector<complex_type, uninitialized_aligned_allocator<complex_type,512>>;
     using Map = std::map<unsigned, unsigned>;
     using RndEngine = std::mt19937;
     using Term = std::vector<std::pair<unsigned, char>>;
     using TermsDict = std::vector<std::pair<Term, calc_type>>;
     using ComplexTermsDict = std::vector<std::pair<Term, complex_type>>;
+    using BufferStatistics = typename BufferPool<StateVector>::Statistics;
+
+    // opcodes of the command buffer executed by apply_commands()
+    enum Opcode : unsigned { OP_ALLOCATE = 0, OP_DEALLOCATE = 1, OP_GATE = 2,
+                             OP_MEASURE = 3, OP_RUN = 4 };
 
-    Simulator(unsigned seed = 1) : N_(0), vec_(1,0.), fusion_qubits_min_(4),
-                                   fusion_qubits_max_(5), rnd_eng_(seed) {
+    SimulatorT(unsigned seed = 1) : N_(0), vec_(1,0.), reserved_size_(1), norm_factor_(1.),
+                                    fusion_qubits_min_(4), fusion_qubits_max_(5), lookahead_(0),
+                                    kernel_level_(max_kernel_level()),
+                                    rnd_eng_(seed), auto_buffer_limit_(true),
+                                    reserved_buffer_bytes_(0) {
         vec_[0]=1.; // all-zero initial state
+        update_buffer_limit(N_);
         std::uniform_real_distribution<double> dist(0., 1.);
         rng_ = std::bind(dist, std::ref(rnd_eng_));
     }
 
     void allocate_qubit(unsigned id){
-        if (map_.count(id) == 0){
-            map_[id] = N_++;
-            StateVector newvec; // avoid large memory allocations
-            if( tmpBuff1_.capacity() >= (1UL << N_) )
-              std::swap(newvec, tmpBuff1_);
-            newvec.resize(1UL << N_);
-#pragma omp parallel for schedule(static)
-            for (std::size_t i = 0; i < newvec.size(); ++i)
-                newvec[i] = (i < vec_.size())?vec_[i]:0.;
+        allocate_qubits({id});
+    }
+
+    // allocates all qubits at once, i.e., the state vector is grown by
+    // 2^ids.size() in a single pass (in place if enough memory has been
+    // reserved)
+    void allocate_qubits(std::vector<unsigned> const& ids){
+        for (unsigned i = 0; i < ids.size(); ++i){
+            if (map_.count(ids[i]) == 1 || std::count(ids.begin(), ids.begin() + i, ids[i]) > 0)
+                throw(std::runtime_error(
+                    "AllocateQubit: ID already exists. Qubit IDs should be unique."));
+        }
+        reclaim_state();
+        std::size_t old_size = vec_.size();
+        std::size_t new_size = old_size << ids.size();
+        if (vec_.capacity() >= new_size){
+            vec_.resize(new_size); // does not touch the new memory
+            #pragma omp parallel for schedule(static)
+            for (std::size_t i = old_size; i < new_size; ++i)
+                vec_[i] = 0.;
+        }
+        else{
+            // avoid large memory allocations
+            auto newvec = buffers_.acquire(std::max(new_size, reserved_size_));
+            newvec.resize(new_size);
+            #pragma omp parallel for schedule(static)
+            for (std::size_t i = 0; i < new_size; ++i)
+                newvec[i] = (i < old_size)?vec_[i]:0.;
             std::swap(vec_, newvec);
             // recycle large memory
-            std::swap(tmpBuff1_, newvec);
-            if( tmpBuff1_.capacity() < tmpBuff2_.capacity() )
-              std::swap(tmpBuff1_, tmpBuff2_);
+            buffers_.release(std::move(newvec));
         }
-        else
-            throw(std::runtime_error(
-                "AllocateQubit: ID already exists. Qubit IDs should be unique."));
+        for (auto id : ids)
+            map_[id] = N_++;
+        update_buffer_limit(N_);
+    }
+
+    // reserves memory for a state vector of up to max_qubits qubits, such
+    // that allocating qubits does not require any copies of the state
+    void reserve(unsigned max_qubits){
+        reserved_size_ = 1UL << max_qubits;
+        update_buffer_limit(N_);
+        reclaim_state();
+        if (vec_.capacity() >= reserved_size_)
+            return;
+        auto newvec = buffers_.acquire(reserved_size_);
+        newvec.resize(vec_.size());
+        #pragma omp parallel for schedule(static)
+        for (std::size_t i = 0; i < vec_.size(); ++i)
+            newvec[i] = vec_[i];
+        std::swap(vec_, newvec);
+        buffers_.release(std::move(newvec));
     }
 
     bool get_classical_value(unsigned id, calc_type tol = 1.e-12){
         run();
+        tol /= norm_factor_ * norm_factor_;
         unsigned pos = map_[id];
         std::size_t delta = (1UL << pos);
 
@@ -92,6 +150,7 @@ public:
 
     bool is_classical(unsigned id, calc_type tol = 1.e-12){
         run();
+        tol /= norm_factor_ * norm_factor_;
         unsigned pos = map_[id];
         std::size_t delta = (1UL << pos);
 
@@ -107,41 +166,6 @@ public:
         return 1 == (up^down);
     }
 
-    void collapse_vector(unsigned id, bool value = false, bool shrink = false){
-        run();
-        unsigned pos = map_[id];
-        std::size_t delta = (1UL << pos);
-
-        if (!shrink){
-            #pragma omp parallel for schedule(static)
-            for (std::size_t i = 0; i < vec_.size(); i += 2*delta){
-                for (std::size_t j = 0; j < delta; ++j)
-                    vec_[i+j+static_cast<std::size_t>(!value)*delta] = 0.;
-            }
-        }
-        else{
-            StateVector newvec; // avoid costly memory reallocations
-            if( tmpBuff1_.capacity() >= (1UL << (N_-1)) )
-              std::swap(tmpBuff1_, newvec);
-            newvec.resize((1UL << (N_-1)));
-            #pragma omp parallel for schedule(static) if(0)
-            for (std::size_t i = 0; i < vec_.size(); i += 2*delta)
-                std::copy_n(&vec_[i + static_cast<std::size_t>(value)*delta],
-                            delta, &newvec[i/2]);
-            std::swap(vec_, newvec);
-            std::swap(tmpBuff1_, newvec);
-            if( tmpBuff1_.capacity() < tmpBuff2_.capacity() )
-              std::swap(tmpBuff1_, tmpBuff2_);
-
-            for (auto& p : map_){
-                if (p.second > pos)
-                    p.second--;
-            }
-            map_.erase(id);
-            N_--;
-        }
-    }
-
     void measure_qubits(std::vector<unsigned> const& ids, std::vector<bool> &res){
         run();
 
@@ -149,15 +173,8 @@ public:
         for (unsigned i = 0; i < ids.size(); ++i)
             positions[i] = map_[ids[i]];
 
-        calc_type P = 0.;
-        calc_type rnd = rng_();
-
         // pick entry at random with probability |entry|^2
-        std::size_t pick = 0;
-        while (P < rnd && pick < vec_.size())
-            P += std::norm(vec_[pick++]);
-
-        pick--;
+        std::size_t pick = sample_index();
         // determine result vector (boolean values for each qubit)
         // and create mask to detect bad entries (i.e., entries that don't agree with measurement)
         res = std::vector<bool>(ids.size());
@@ -170,7 +187,7 @@ public:
             val |= (static_cast<std::size_t>(r&1) << positions[i]);
         }
         // set bad entries to 0
-        calc_type N = 0.;
+        double N = 0.;
         #pragma omp parallel for reduction(+:N) schedule(static)
         for (std::size_t i = 0; i < vec_.size(); ++i){
             if ((i & mask) != val)
@@ -178,11 +195,39 @@ public:
             else
                 N += std::norm(vec_[i]);
         }
-        // re-normalize
-        N = 1./std::sqrt(N);
+        // re-normalize (deferred to the next gate)
+        norm_factor_ = 1./std::sqrt(N);
+    }
+
+    // draws `shots` samples of the given qubits from the current state without
+    // collapsing it; bit i of each outcome is the value of qubit ids[i]. The
+    // cumulative distribution (of the marginal if it is small) is built once
+    // and all shots are drawn by binary search.
+    std::vector<std::uint64_t> sample(std::vector<unsigned> const& ids, std::size_t shots){
+        run();
+        if (!check_ids(ids))
+            throw(std::runtime_error("sample(): Unknown qubit id(s) provided. Try calling eng.flush() before invoking this function."));
+        if (ids.size() > 64)
+            throw(std::invalid_argument("sample(): At most 64 qubits can be sampled at once."));
+        std::vector<unsigned> positions(ids.size());
+        for (unsigned i = 0; i < ids.size(); ++i)
+            positions[i] = map_[ids[i]];
+
+        bool marginal = ids.size() < N_ && ((vec_.size() >> ids.size()) >= num_blocks_);
+        auto cdf = marginal ? cumulative_probabilities(positions)
+                            : cumulative_probabilities();
+
+        std::vector<double> rnd(shots);
+        for (auto& r : rnd)
+            r = rng_() * cdf.back();
+        std::vector<std::uint64_t> res(shots);
         #pragma omp parallel for schedule(static)
-        for (std::size_t i = 0; i < vec_.size(); ++i)
-            vec_[i] *= N;
+        for (std::size_t s = 0; s < shots; ++s){
+            std::size_t i = std::upper_bound(cdf.begin(), cdf.end(), rnd[s]) - cdf.begin();
+            i = std::min(i, cdf.size() - 1);
+            res[s] = marginal ? i : extract_bits(i, positions.data(), positions.size());
+        }
+        return res;
     }
 
     std::vector<bool> measure_qubits_return(std::vector<unsigned> const& ids){
@@ -192,144 +237,318 @@ public:
     }
 
     void deallocate_qubit(unsigned id){
+        deallocate_qubits({id});
+    }
+
+    // deallocates several qubits at once: one pass over the state checks that
+    // all of them are in a classical state (and determines their values),
+    // a second pass removes them from the state vector
+    void deallocate_qubits(std::vector<unsigned> const& ids, calc_type tol = 1.e-12){
         run();
-        assert(map_.count(id) == 1);
-        if (!is_classical(id))
+        if (!check_ids(ids))
+            throw(std::runtime_error("DeallocateQubit: Unknown qubit id."));
+        auto mask = get_control_mask(ids);
+        tol /= norm_factor_ * norm_factor_;
+
+        std::size_t seen0 = 0, seen1 = 0;
+        #pragma omp parallel for schedule(static) reduction(|:seen0,seen1)
+        for (std::size_t i = 0; i < vec_.size(); ++i){
+            if (std::norm(vec_[i]) > tol){
+                seen0 |= ~i & mask;
+                seen1 |= i & mask;
+            }
+        }
+        if ((seen0 & seen1) != 0 || (seen0 | seen1) != mask)
             throw(std::runtime_error("Error: Qubit has not been measured / uncomputed! There is most likely a bug in your code."));
 
-        bool value = get_classical_value(id);
-        collapse_vector(id, value, true);
+        remove_qubits(ids, seen1);
     }
 
+    // measures the given qubits and removes them from the state vector right
+    // away, i.e., the collapsed and renormalized state is written directly
+    // into a state vector of half the size per measured qubit
+    std::vector<bool> measure_and_release(std::vector<unsigned> const& ids){
+        run();
+        if (!check_ids(ids))
+            throw(std::runtime_error("measure_and_release(): Unknown qubit id."));
+        std::size_t pick = sample_index();
+        std::vector<bool> res(ids.size());
+        std::size_t val = 0;
+        for (unsigned i = 0; i < ids.size(); ++i){
+            res[i] = ((pick >> map_[ids[i]]) & 1) == 1;
+            val |= (static_cast<std::size_t>(res[i]) << map_[ids[i]]);
+        }
+        remove_qubits(ids, val, true);
+        return res;
+    }
+
+    // gates given as a vector of rows (e.g. from Python) are converted to
+    // the flat matrix layout of Fusion and the kernels first
     template <class M>
     void apply_controlled_gate(M const& m, const std::vector<unsigned>& ids,
                                const std::vector<unsigned>& ctrl){
-        auto fused_gates = fused_gates_;
-        fused_gates.insert(m, ids, ctrl);
+        apply_controlled_gate(Fusion::Matrix(m), ids, ctrl);
+    }
 
-        if (fused_gates.num_qubits() >= fusion_qubits_min_
-                && fused_gates.num_qubits() <= fusion_qubits_max_){
-            fused_gates_ = fused_gates;
+    void apply_controlled_gate(Fusion::Matrix m, const std::vector<unsigned>& ids,
+                               const std::vector<unsigned>& ctrl){
+        if (lookahead_ > 0){
+            scheduler_.push(std::move(m), ids, ctrl);
+            if (scheduler_.size() >= lookahead_)
+                schedule_gates();
+            return;
+        }
+        // diagonal gates are collected separately (and do not count towards
+        // the size of the fused matrix), other gates may only be fused if
+        // they commute with the pending diagonal gates
+        if (Fusion::collects_as_diagonal(m, ctrl)){
+            fused_gates_.insert_diagonal(m, ids, ctrl);
+            return;
+        }
+        if (!fused_gates_.commutes_with_diagonal(ids))
             run();
+
+        // size of the fused matrix if the gate was added (without copying
+        // the collected gates to find out)
+        unsigned num_qubits = fused_gates_.num_qubits_if_inserted(ids, ctrl);
+
+        if (fusion_costs_.size() > 0){
+            if (!extend_fusion(num_qubits, ids.size()))
+                run();
+            fused_gates_.insert(std::move(m), ids, ctrl);
+            return;
         }
-        else if (fused_gates.num_qubits() > fusion_qubits_max_
-                 || (fused_gates.num_qubits() - ids.size()) > fused_gates_.num_qubits()){
+        if (num_qubits >= fusion_qubits_min_ && num_qubits <= fusion_qubits_max_){
+            fused_gates_.insert(std::move(m), ids, ctrl);
             run();
-            fused_gates_.insert(m, ids, ctrl);
+            return;
         }
-        else
-            fused_gates_ = fused_gates;
+        if (num_qubits > fusion_qubits_max_
+                || (num_qubits - ids.size()) > fused_gates_.num_qubits())
+            run();
+        fused_gates_.insert(std::move(m), ids, ctrl);
     }
 
+    // applies the (classical, reversible) function f to the values of the
+    // quantum registers quregs in each basis state where all controls are 1.
+    // Each amplitude is moved to its image in a scratch buffer (in parallel if
+    // parallelize is true); if f turns out not to be a bijection, i.e., two
+    // amplitudes are moved to the same index, the amplitudes are summed up
+    // serially instead.
     template <class F, class QuReg>
     void emulate_math(F const& f, QuReg quregs, const std::vector<unsigned>& ctrl,
                       bool parallelize = false){
         run();
         auto ctrlmask = get_control_mask(ctrl);
 
-        for (unsigned i = 0; i < quregs.size(); ++i)
-            for (unsigned j = 0; j < quregs[i].size(); ++j)
-                quregs[i][j] = map_[quregs[i][j]];
+        std::vector<RegisterLayout> layouts;
+        for (auto const& qureg : quregs)
+            layouts.push_back(get_register_layout(qureg));
 
-        StateVector newvec; // avoid costly memory reallocations
-        if( tmpBuff1_.capacity() >= vec_.size() )
-          std::swap(newvec, tmpBuff1_);
-        newvec.resize(vec_.size());
-#pragma omp parallel for schedule(static)
-        for (std::size_t i = 0; i < vec_.size(); i++)
-          newvec[i] = 0;
+        auto newvec = buffers_.acquire(vec_.size()); // avoid costly memory reallocations
+        // bitmap of the indices which have been written (to detect collisions)
+        std::size_t const num_words = (vec_.size() + 63) / 64;
+        std::unique_ptr<std::atomic<std::uint64_t>[]> written(new std::atomic<std::uint64_t>[num_words]);
+        #pragma omp parallel for schedule(static) if(parallelize)
+        for (std::size_t w = 0; w < num_words; ++w)
+            written[w].store(0, std::memory_order_relaxed);
 
-//#pragma omp parallel reduction(+:newvec[:newvec.size()]) if(parallelize) // requires OpenMP 4.5
+        int collision = 0;
+        #pragma omp parallel reduction(|:collision) if(parallelize)
         {
-          std::vector<int> res(quregs.size());
-          //#pragma omp for schedule(static)
-          for (std::size_t i = 0; i < vec_.size(); ++i){
-              if ((ctrlmask&i) == ctrlmask){
-                  for (unsigned qr_i = 0; qr_i < quregs.size(); ++qr_i){
-                      res[qr_i] = 0;
-                      for (unsigned qb_i = 0; qb_i < quregs[qr_i].size(); ++qb_i)
-                          res[qr_i] |= ((i >> quregs[qr_i][qb_i])&1) << qb_i;
-                  }
-                  f(res);
-                  auto new_i = i;
-                  for (unsigned qr_i = 0; qr_i < quregs.size(); ++qr_i){
-                      for (unsigned qb_i = 0; qb_i < quregs[qr_i].size(); ++qb_i){
-                          if (!(((new_i >> quregs[qr_i][qb_i])&1) == ((res[qr_i] >> qb_i)&1)))
-                              new_i ^= (1UL << quregs[qr_i][qb_i]);
-                      }
-                  }
-                  newvec[new_i] += vec_[i];
-              }
-              else
-                  newvec[i] += vec_[i];
-          }
+            std::vector<int> res(layouts.size());
+            #pragma omp for schedule(static)
+            for (std::size_t i = 0; i < vec_.size(); ++i){
+                auto new_i = i;
+                if ((ctrlmask&i) == ctrlmask){
+                    for (unsigned qr_i = 0; qr_i < layouts.size(); ++qr_i)
+                        res[qr_i] = static_cast<int>(layouts[qr_i].value(i));
+                    f(res);
+                    for (unsigned qr_i = 0; qr_i < layouts.size(); ++qr_i)
+                        new_i = layouts[qr_i].assign(new_i, static_cast<std::uint64_t>(res[qr_i]));
+                }
+                std::uint64_t const bit = std::uint64_t(1) << (new_i % 64);
+                if (written[new_i / 64].fetch_or(bit, std::memory_order_relaxed) & bit)
+                    collision = 1;
+                newvec[new_i] = vec_[i];
+            }
+        }
+
+        if (collision){
+            #pragma omp parallel for schedule(static)
+            for (std::size_t i = 0; i < vec_.size(); i++)
+                newvec[i] = 0;
+            std::vector<int> res(layouts.size());
+            for (std::size_t i = 0; i < vec_.size(); ++i){
+                auto new_i = i;
+                if ((ctrlmask&i) == ctrlmask){
+                    for (unsigned qr_i = 0; qr_i < layouts.size(); ++qr_i)
+                        res[qr_i] = static_cast<int>(layouts[qr_i].value(i));
+                    f(res);
+                    for (unsigned qr_i = 0; qr_i < layouts.size(); ++qr_i)
+                        new_i = layouts[qr_i].assign(new_i, static_cast<std::uint64_t>(res[qr_i]));
+                }
+                newvec[new_i] += vec_[i];
+            }
+        }
+        else{
+            // entries which were not hit by any amplitude
+            #pragma omp parallel for schedule(static)
+            for (std::size_t w = 0; w < num_words; ++w){
+                auto missing = ~written[w].load(std::memory_order_relaxed);
+                for (; missing != 0 && w * 64 + ctz(missing) < vec_.size(); missing &= missing - 1)
+                    newvec[w * 64 + ctz(missing)] = 0.;
+            }
         }
         std::swap(vec_, newvec);
-        std::swap(tmpBuff1_, newvec);
+        buffers_.release(std::move(newvec));
     }
 
-    // faster version without calling python 
+    // faster versions without calling python: the arithmetic on a single
+    // register is applied in place as a permutation of the register values.
+    // Several registers fall back to emulate_math, as do the modular versions
+    // if a register value >= N occurs in the state (which the permutation of
+    // the values below N does not cover).
     template<class QuReg>
-    inline void emulate_math_addConstant(int a, const QuReg& quregs, const std::vector<unsigned>& ctrl)
+    inline void emulate_math_addConstant(std::int64_t a, const QuReg& quregs, const std::vector<unsigned>& ctrl)
     {
-      emulate_math([a](std::vector<int> &res){for(auto& x: res) x = x + a;}, quregs, ctrl, true);
+      if (quregs.size() != 1 || quregs[0].size() >= 64){
+        emulate_math([a](std::vector<int> &res){for(auto& x: res) x = static_cast<int>(x + a);}, quregs, ctrl, true);
+        return;
+      }
+      run();
+      auto layout = get_register_layout(quregs[0]);
+      std::uint64_t L = std::uint64_t(1) << layout.positions.size();
+      rotate_register(layout, get_control_mask(ctrl), L, static_cast<std::uint64_t>(a) & (L - 1));
     }
 
-    // faster version without calling python 
     template<class QuReg>
-    inline void emulate_math_addConstantModN(int a, int N, const QuReg& quregs, const std::vector<unsigned>& ctrl)
+    inline void emulate_math_addConstantModN(std::int64_t a, std::int64_t N, const QuReg& quregs, const std::vector<unsigned>& ctrl)
     {
-      emulate_math([a,N](std::vector<int> &res){for(auto& x: res) x = (x + a) % N;}, quregs, ctrl, true);
+      if (N <= 0)
+        throw(std::invalid_argument("emulate_math_addConstantModN(): N must be positive."));
+      std::int64_t a_mod = ((a % N) + N) % N;
+      if (quregs.size() != 1 || quregs[0].size() >= 64
+          || static_cast<std::uint64_t>(N) > (std::uint64_t(1) << quregs[0].size())){
+        emulate_math([a_mod,N](std::vector<int> &res){for(auto& x: res) x = static_cast<int>((x + a_mod) % N);}, quregs, ctrl, true);
+        return;
+      }
+      run();
+      auto layout = get_register_layout(quregs[0]);
+      auto ctrlmask = get_control_mask(ctrl);
+      if (has_register_values(layout, ctrlmask, N)){
+        emulate_math([a_mod,N](std::vector<int> &res){for(auto& x: res) x = static_cast<int>((x + a_mod) % N);}, quregs, ctrl, true);
+        return;
+      }
+      rotate_register(layout, ctrlmask, N, a_mod);
     }
 
-    // faster version without calling python 
     template<class QuReg>
-    inline void emulate_math_multiplyByConstantModN(int a, int N, const QuReg& quregs, const std::vector<unsigned>& ctrl)
+    inline void emulate_math_multiplyByConstantModN(std::int64_t a, std::int64_t N, const QuReg& quregs, const std::vector<unsigned>& ctrl)
     {
-      emulate_math([a,N](std::vector<int> &res){for(auto& x: res) x = (x * a) % N;}, quregs, ctrl, true);
+      if (N <= 0)
+        throw(std::invalid_argument("emulate_math_multiplyByConstantModN(): N must be positive."));
+      std::int64_t a_mod = ((a % N) + N) % N;
+      if (quregs.size() != 1 || quregs[0].size() >= 64 || N > (std::int64_t(1) << 32)
+          || static_cast<std::uint64_t>(N) > (std::uint64_t(1) << quregs[0].size())
+          || gcd(a_mod, N) != 1){
+        emulate_math([a_mod,N](std::vector<int> &res){for(auto& x: res) x = static_cast<int>((x * a_mod) % N);}, quregs, ctrl, true);
+        return;
+      }
+      run();
+      auto layout = get_register_layout(quregs[0]);
+      auto ctrlmask = get_control_mask(ctrl);
+      if (has_register_values(layout, ctrlmask, N)){
+        emulate_math([a_mod,N](std::vector<int> &res){for(auto& x: res) x = static_cast<int>((x * a_mod) % N);}, quregs, ctrl, true);
+        return;
+      }
+      // x -> a*x mod N is a bijection on [0, N); find its cycles
+      std::uint64_t const n = N, m = a_mod, m_inv = mod_inverse(a_mod, N);
+      std::vector<std::uint64_t> leaders;
+      std::vector<bool> visited(n, false);
+      for (std::uint64_t x = 0; x < n; ++x){
+        if (visited[x])
+          continue;
+        std::uint64_t y = x;
+        do{
+          visited[y] = true;
+          y = (y * m) % n;
+        } while (y != x);
+        if ((x * m) % n != x)
+          leaders.push_back(x);
+      }
+      permute_register(layout, ctrlmask, leaders.size(),
+                       [&leaders](std::size_t c){ return leaders[c]; },
+                       [n, m_inv](std::uint64_t x){ return (x * m_inv) % n; });
     }
 
-    calc_type get_expectation_value(TermsDict const& td, std::vector<unsigned> const& ids){
+    // applies the function given by a table of the concatenated register
+    // values (quregs[0] in the lowest bits) where all controls are 1: in place
+    // by cycle following if the table is a permutation, using emulate_math
+    // otherwise
+    template <class QuReg>
+    void emulate_math_table(std::vector<std::uint64_t> const& table, QuReg const& quregs,
+                            std::vector<unsigned> const& ctrl){
         run();
-        calc_type expectation = 0.;
+        std::vector<unsigned> ids;
+        for (auto const& qureg : quregs)
+            ids.insert(ids.end(), qureg.begin(), qureg.end());
+        if (ids.size() >= 32 || table.size() != (std::size_t(1) << ids.size()))
+            throw(std::invalid_argument("emulate_math_table(): The table must contain 2^n entries for n register qubits."));
 
-        StateVector current_state; // avoid costly memory reallocations
-        if( tmpBuff1_.capacity() >= vec_.size() )
-          std::swap(tmpBuff1_, current_state);
-        current_state.resize(vec_.size());
-#pragma omp parallel for schedule(static)
-        for (std::size_t i = 0; i < vec_.size(); ++i)
-          current_state[i] = vec_[i];
+        std::vector<std::uint64_t> inverse(table.size(), table.size());
+        bool bijective = true;
+        for (std::size_t x = 0; x < table.size() && bijective; ++x){
+            bijective = table[x] < table.size() && inverse[table[x]] == table.size();
+            if (bijective)
+                inverse[table[x]] = x;
+        }
+        if (!bijective){
+            emulate_math([&table](std::vector<int> &res){ res[0] = static_cast<int>(table[res[0]]); },
+                         std::vector<std::vector<unsigned>>{ids}, ctrl, true);
+            return;
+        }
 
-        for (auto const& term : td){
-            auto const& coefficient = term.second;
-            apply_term(term.first, ids, {});
-            calc_type delta = 0.;
+        std::vector<std::uint64_t> leaders;
+        std::vector<bool> visited(table.size(), false);
+        for (std::uint64_t x = 0; x < table.size(); ++x){
+            if (visited[x])
+                continue;
+            for (auto y = x; !visited[y]; y = table[y])
+                visited[y] = true;
+            if (table[x] != x)
+                leaders.push_back(x);
+        }
+        permute_register(get_register_layout(ids), get_control_mask(ctrl), leaders.size(),
+                         [&leaders](std::size_t c){ return leaders[c]; },
+                         [&inverse](std::uint64_t x){ return inverse[x]; });
+    }
+
+    calc_type get_expectation_value(TermsDict const& td, std::vector<unsigned> const& ids){
+        run();
+        double expectation = 0.;
+        for (auto const& group : group_pauli_terms(td, ids)){
+            auto const flip = group.first;
+            auto const& terms = group.second;
+            double delta = 0.;
             #pragma omp parallel for reduction(+:delta) schedule(static)
             for (std::size_t i = 0; i < vec_.size(); ++i){
-                auto const a1 = std::real(current_state[i]);
-                auto const b1 = -std::imag(current_state[i]);
-                auto const a2 = std::real(vec_[i]);
-                auto const b2 = std::imag(vec_[i]);
-                delta += a1 * a2 - b1 * b2;
-                // reset vec_
-                vec_[i] = current_state[i];
+                complex_type w = 0.;
+                for (auto const& t : terms)
+                    w += parity(i & t.first) ? -t.second : t.second;
+                delta += std::real(std::conj(vec_[i ^ flip]) * vec_[i] * w);
             }
-            expectation += coefficient * delta;
+            expectation += delta;
         }
-        std::swap(current_state, tmpBuff1_);
-        return expectation;
+        return expectation * norm_factor_ * norm_factor_;
     }
 
     void apply_qubit_operator(ComplexTermsDict const& td, std::vector<unsigned> const& ids){
         run();
-        StateVector new_state, current_state; // avoid costly memory reallocations
-        if( tmpBuff1_.capacity() >= vec_.size() )
-          std::swap(tmpBuff1_, new_state);
-        if( tmpBuff2_.capacity() >= vec_.size() )
-          std::swap(tmpBuff2_, current_state);
-        new_state.resize(vec_.size());
-        current_state.resize(vec_.size());
+        normalize();
+        // avoid costly memory reallocations
+        auto new_state = buffers_.acquire(vec_.size());
+        auto current_state = buffers_.acquire(vec_.size());
 #pragma omp parallel for schedule(static)
         for (std::size_t i = 0; i < vec_.size(); ++i){
           new_state[i] = 0;
@@ -345,8 +564,8 @@ public:
             }
         }
         std::swap(vec_, new_state);
-        std::swap(tmpBuff1_, new_state);
-        std::swap(tmpBuff2_, current_state);
+        buffers_.release(std::move(new_state));
+        buffers_.release(std::move(current_state));
     }
 
     calc_type get_probability(std::vector<bool> const& bit_string,
@@ -359,15 +578,15 @@ public:
             mask |= 1UL << map_[ids[i]];
             bit_str |= (bit_string[i]?1UL:0UL) << map_[ids[i]];
         }
-        calc_type probability = 0.;
+        double probability = 0.;
         #pragma omp parallel for reduction(+:probability) schedule(static)
         for (std::size_t i = 0; i < vec_.size(); ++i)
             if ((i & mask) == bit_str)
                 probability += std::norm(vec_[i]);
-        return probability;
+        return probability * norm_factor_ * norm_factor_;
     }
 
-    complex_type const& get_amplitude(std::vector<bool> const& bit_string,
+    complex_type get_amplitude(std::vector<bool> const& bit_string,
                                       std::vector<unsigned> const& ids){
         run();
         std::size_t chk = 0;
@@ -380,13 +599,23 @@ public:
         }
         if (chk + 1 != vec_.size())
             throw(std::runtime_error("The second argument to get_amplitude() must be a permutation of all allocated qubits. Please make sure you have called eng.flush()."));
-        return vec_[index];
+        return vec_[index] * norm_factor_;
     }
 
+    // applies exp(-i*time*H) to the subspace where all control qubits are 1,
+    // using a Chebyshev expansion of the propagator: with the norm bound
+    // rho = sum_k |c_k| of the non-identity terms,
+    //   exp(-i*t*H) = sum_k (2 - delta_k0) (-i)^k J_k(rho*t) T_k(H/rho),
+    // where the number of terms follows from the decay of the Bessel
+    // functions J_k. Each order costs a single sweep (three-term recurrence)
+    // and only two scratch buffers from the pool are needed.
+    // Diagonal Hamiltonians (only Z terms) are applied as phases in one sweep.
     void emulate_time_evolution(TermsDict const& tdict, calc_type const& time,
                                 std::vector<unsigned> const& ids,
-                                std::vector<unsigned> const& ctrl){
+                                std::vector<unsigned> const& ctrl,
+                                calc_type tol = 1.e-12){
         run();
+        normalize();
         complex_type I(0., 1.);
         calc_type tr = 0., op_nrm = 0.;
         TermsDict td;
@@ -398,49 +627,116 @@ public:
                 op_nrm += std::abs(tdict[i].second);
             }
         }
-        unsigned s = std::abs(time) * op_nrm + 1.;
-        complex_type correction = std::exp(-time * I * tr / (double)s);
-        auto output_state = vec_;
         auto ctrlmask = get_control_mask(ctrl);
-        for (unsigned i = 0; i < s; ++i){
-            calc_type nrm_change = 1.;
-            for (unsigned k = 0; nrm_change > 1.e-12; ++k){
-                auto coeff = (-time * I) / double(s * (k + 1));
-                auto current_state = vec_;
-                auto update = StateVector(vec_.size(), 0.);
-                for (auto const& tup : td){
-                    apply_term(tup.first, ids, {});
-                    #pragma omp parallel for schedule(static)
-                    for (std::size_t j = 0; j < vec_.size(); ++j){
-                        update[j] += vec_[j] * tup.second;
-                        vec_[j] = current_state[j];
-                    }
-                }
-                nrm_change = 0.;
-                #pragma omp parallel for reduction(+:nrm_change) schedule(static)
-                for (std::size_t j = 0; j < vec_.size(); ++j){
-                    update[j] *= coeff;
-                    vec_[j] = update[j];
-                    if ((j & ctrlmask) == ctrlmask){
-                        output_state[j] += update[j];
-                        nrm_change += std::norm(update[j]);
-                    }
-                }
-                nrm_change = std::sqrt(nrm_change);
-            }
+        complex_type correction = std::exp(-time * I * tr);
+        if (op_nrm == 0. || time == 0.){
             #pragma omp parallel for schedule(static)
-            for (std::size_t j = 0; j < vec_.size(); ++j){
+            for (std::size_t j = 0; j < vec_.size(); ++j)
                 if ((j & ctrlmask) == ctrlmask)
-                    output_state[j] *= correction;
-                vec_[j] = output_state[j];
+                    vec_[j] *= correction;
+            return;
+        }
+
+        auto groups = group_pauli_terms(td, ids);
+        if (groups.size() == 1 && groups[0].first == 0){
+            apply_diagonal_evolution(groups[0].second, time, correction, ctrlmask);
+            return;
+        }
+        if (td.size() == 1){ // exp(-i*t*c*P) is a single Pauli rotation
+            apply_pauli_rotations({{td[0].first, time * td[0].second}, {Term(), time * tr}},
+                                  ids, ctrl);
+            return;
+        }
+
+        // expansion coefficients (including the global phase of the identity)
+        auto J = bessel_j(std::abs(double(time)) * op_nrm, tol);
+        std::vector<complex_type> c(J.size());
+        complex_type const rot = time > 0 ? -I : I;
+        complex_type rot_k = 1.;
+        for (std::size_t k = 0; k < J.size(); ++k, rot_k *= rot)
+            c[k] = calc_type(k == 0 ? 1 : 2) * rot_k * calc_type(J[k]) * correction;
+
+        for (auto& group : groups)
+            for (auto& t : group.second)
+                t.second /= op_nrm;
+        // phi_k = T_k(H/rho) psi, the recurrence overwrites phi_{k-1} by phi_{k+1}
+        StateVector prev;
+        std::swap(prev, vec_);
+        auto cur = buffers_.acquire(prev.size());
+        auto result = buffers_.acquire(prev.size());
+        #pragma omp parallel for schedule(static)
+        for (std::size_t j = 0; j < prev.size(); ++j){
+            if ((j & ctrlmask) == ctrlmask){
+                cur[j] = apply_pauli_groups(groups, prev, j);
+                result[j] = c[0] * prev[j] + (c.size() > 1 ? c[1] : 0.) * cur[j];
             }
+            else
+                result[j] = prev[j];
+        }
+        for (std::size_t k = 2; k < c.size(); ++k){
+            auto const ck = c[k];
+            #pragma omp parallel for schedule(static)
+            for (std::size_t j = 0; j < prev.size(); ++j){
+                if ((j & ctrlmask) == ctrlmask){
+                    prev[j] = calc_type(2) * apply_pauli_groups(groups, cur, j) - prev[j];
+                    result[j] += ck * prev[j];
+                }
+            }
+            std::swap(prev, cur);
+        }
+        std::swap(vec_, result);
+        buffers_.release(std::move(prev));
+        buffers_.release(std::move(cur));
+        buffers_.release(std::move(result));
+    }
+
+    // applies exp(-i*theta_k*P_k) for the Pauli strings P_k in the given order,
+    // repeated num_steps times (e.g., the steps of a Trotter product), to the
+    // subspace where all control qubits are 1. Each rotation pairs the
+    // amplitudes i and i^flip; consecutive rotations whose flip masks span at
+    // most max_block_qubits_ qubits are applied together, block by block,
+    // such that each block stays in cache (possibly for several steps).
+    void apply_pauli_rotations(TermsDict const& rotations, std::vector<unsigned> const& ids,
+                               std::vector<unsigned> const& ctrl, unsigned num_steps = 1){
+        run();
+        auto ctrlmask = get_control_mask(ctrl);
+        std::vector<PauliMasks> step_masks;
+        for (auto const& rot : rotations)
+            step_masks.push_back(get_pauli_masks(rot.first, ids));
+        TermsDict sequence;
+        std::vector<PauliMasks> masks;
+        for (unsigned step = 0; step < num_steps; ++step){
+            sequence.insert(sequence.end(), rotations.begin(), rotations.end());
+            masks.insert(masks.end(), step_masks.begin(), step_masks.end());
+        }
+
+        std::size_t begin = 0;
+        while (begin < sequence.size()){
+            std::size_t flips = masks[begin].flip;
+            std::size_t end = begin + 1;
+            while (end < sequence.size()
+                   && popcount(flips | masks[end].flip) <= max_block_qubits_)
+                flips |= masks[end++].flip;
+            if (popcount(flips) <= max_block_qubits_)
+                apply_pauli_rotation_block(sequence, masks, begin, end, flips, ctrlmask);
+            else
+                apply_pauli_rotation(masks[begin], sequence[begin].second, ctrlmask);
+            begin = end;
         }
     }
 
     void set_wavefunction(StateVector const& wavefunction, std::vector<unsigned> const& ordering){
+        set_wavefunction(wavefunction.data(), wavefunction.size(), ordering);
+    }
+
+    // sets the wavefunction from a contiguous array of `size` amplitudes
+    // (copied directly into the state vector without a temporary)
+    void set_wavefunction(complex_type const* wavefunction, std::size_t size,
+                          std::vector<unsigned> const& ordering){
         run();
         // make sure there are 2^n amplitudes for n qubits
-        assert(wavefunction.size() == (1UL << ordering.size()));
+        if (size != (1UL << ordering.size()))
+            throw(std::runtime_error("set_wavefunction(): The wavefunction must contain 2^n amplitudes for n qubits."));
         // check that all qubits have been allocated previously
         if (map_.size() != ordering.size() || !check_ids(ordering))
             throw(std::runtime_error("set_wavefunction(): Invalid mapping provided. Please make sure all qubits have been allocated previously (call eng.flush())."));
@@ -449,8 +745,9 @@ public:
         for (unsigned i = 0; i < ordering.size(); ++i)
             map_[ordering[i]] = i;
         #pragma omp parallel for schedule(static)
-        for (std::size_t i = 0; i < wavefunction.size(); ++i)
+        for (std::size_t i = 0; i < size; ++i)
             vec_[i] = wavefunction[i];
+        norm_factor_ = 1.;
     }
 
     void collapse_wavefunction(std::vector<unsigned> const& ids, std::vector<bool> const& values){
@@ -463,90 +760,948 @@ public:
             mask |= (1UL << map_[ids[i]]);
             val |= ((values[i]?1UL:0UL) << map_[ids[i]]);
         }
-        // set bad entries to 0 and compute probability of outcome to renormalize
-        calc_type N = 0.;
+        // compute probability of outcome to renormalize
+        double N = 0.;
         #pragma omp parallel for reduction(+:N) schedule(static)
         for (std::size_t i = 0; i < vec_.size(); ++i){
             if ((i & mask) == val)
                 N += std::norm(vec_[i]);
         }
-        if (N < 1.e-12)
+        if (N * norm_factor_ * norm_factor_ < 1.e-12)
             throw(std::runtime_error("collapse_wavefunction(): Invalid collapse! Probability is ~0."));
-        // re-normalize (if possible)
-        N = 1./std::sqrt(N);
+        // set bad entries to 0, re-normalization is deferred to the next gate
         #pragma omp parallel for schedule(static)
         for (std::size_t i = 0; i < vec_.size(); ++i){
             if ((i & mask) != val)
                 vec_[i] = 0.;
-            else
-                vec_[i] *= N;
         }
+        norm_factor_ = 1./std::sqrt(N);
     }
 
+    // applies all pending gates
     void run(){
+        reclaim_state();
+        if (scheduler_.size() > 0)
+            schedule_gates();
+        apply_fused_gates();
+    }
+
+    // Executes a whole block of commands in a single call. Each command in
+    // `program` consists of a header {opcode, #targets, #controls, aux}
+    // followed by the target ids and the control ids. For OP_GATE, aux is the
+    // offset of the row-major 2^k x 2^k gate matrix (in double precision,
+    // independently of calc_type) in `matrices`; for
+    // OP_MEASURE, aux is the slot of the first outcome in `results`.
+    void apply_commands(std::vector<unsigned> const& program,
+                        Fusion::Complex const* matrices, std::size_t num_entries,
+                        std::vector<bool>& results){
+        std::vector<unsigned> ids, ctrl;
+        std::vector<bool> outcome;
+        std::size_t pc = 0;
+        while (pc < program.size()){
+            if (pc + 4 > program.size())
+                throw(std::runtime_error("apply_commands(): Truncated command header."));
+            unsigned op = program[pc], num_ids = program[pc+1];
+            unsigned num_ctrls = program[pc+2], aux = program[pc+3];
+            pc += 4;
+            if (pc + num_ids + num_ctrls > program.size())
+                throw(std::runtime_error("apply_commands(): Truncated command arguments."));
+            ids.assign(program.begin() + pc, program.begin() + pc + num_ids);
+            pc += num_ids;
+            ctrl.assign(program.begin() + pc, program.begin() + pc + num_ctrls);
+            pc += num_ctrls;
+
+            switch (op){
+                case OP_ALLOCATE:
+                    allocate_qubits(ids);
+                    break;
+                case OP_DEALLOCATE:
+                    deallocate_qubits(ids);
+                    break;
+                case OP_GATE:{
+                    std::size_t dim = 1UL << num_ids;
+                    if (aux + dim * dim > num_entries)
+                        throw(std::runtime_error("apply_commands(): Gate matrix out of range."));
+                    Fusion::Matrix m(dim);
+                    std::copy_n(matrices + aux, dim * dim, m.data());
+                    apply_controlled_gate(std::move(m), ids, ctrl);
+                    break;
+                }
+                case OP_MEASURE:
+                    // measurement followed by the deallocation of the same
+                    // qubits: collapse and release them in one go
+                    if (pc + 4 + num_ids <= program.size()
+                            && program[pc] == OP_DEALLOCATE
+                            && program[pc+1] == num_ids && program[pc+2] == 0
+                            && std::is_permutation(ids.begin(), ids.end(),
+                                                   program.begin() + pc + 4)){
+                        outcome = measure_and_release(ids);
+                        pc += 4 + num_ids;
+                    }
+                    else
+                        measure_qubits(ids, outcome);
+                    if (results.size() < aux + outcome.size())
+                        results.resize(aux + outcome.size());
+                    std::copy(outcome.begin(), outcome.end(), results.begin() + aux);
+                    break;
+                case OP_RUN:
+                    run();
+                    break;
+                default:
+                    throw(std::invalid_argument("apply_commands(): Unknown opcode."));
+            }
+        }
+    }
+
+    // Returns the qubit map and the normalized state vector without copying
+    // it: the buffer is lent out and only taken back at the next operation,
+    // or copied if the caller still holds it then (see reclaim_state()).
+    // Hence, the returned state is a snapshot which stays valid as long as
+    // it is referenced.
+    std::tuple<Map, std::shared_ptr<StateVector const>> cheat(){
+        if (!lent_state_ || scheduler_.size() > 0 || fused_gates_.size() > 0){
+            run();
+            normalize();
+            lent_state_ = std::make_shared<StateVector>(std::move(vec_));
+        }
+        return std::make_tuple(map_, std::shared_ptr<StateVector const>(lent_state_));
+    }
+
+    // makes sure that `count` scratch buffers for up to `num_qubits` qubits
+    // are available, such that they are not allocated during the simulation
+    // (raises the automatic limit of cached buffers accordingly)
+    void reserve_buffers(unsigned num_qubits, unsigned count = 2){
+        reserved_buffer_bytes_ = count * (sizeof(complex_type) << num_qubits);
+        update_buffer_limit(N_);
+        buffers_.reserve(1UL << num_qubits, count);
+    }
+
+    // frees cached scratch buffers until at most max_bytes are held
+    void trim_buffers(std::size_t max_bytes = 0){
+        buffers_.trim(max_bytes);
+    }
+
+    // limits the memory held by cached scratch buffers to max_bytes instead
+    // of the default of one buffer of the size of the (reserved) state vector
+    void set_buffer_limit(std::size_t max_bytes){
+        auto_buffer_limit_ = false;
+        buffers_.set_max_bytes(max_bytes);
+    }
+
+    BufferStatistics const& get_buffer_statistics() const{
+        return buffers_.statistics();
+    }
+
+    // selects the gate kernels by instruction set ("scalar", "avx2" or
+    // "avx512"), e.g. for benchmarking. By default, the best kernels
+    // supported by the CPU are used.
+    void set_kernels(std::string const& isa){
+        for (unsigned level = 0; level < 3; ++level){
+            if (isa == kernel_names()[level]){
+                if (level > max_kernel_level())
+                    throw(std::runtime_error("set_kernels(): The " + isa + " kernels are not available on this CPU (or in this build)."));
+                run();
+                kernel_level_ = level;
+                return;
+            }
+        }
+        throw(std::invalid_argument("set_kernels(): Unknown instruction set " + isa + "."));
+    }
+
+    std::string get_kernels() const{
+        return kernel_names()[kernel_level_];
+    }
+
+    // Measures the time (in seconds, best of `repetitions` runs) of applying
+    // a general k-qubit gate to a state of num_qubits qubits with the
+    // selected kernels, for k = 1, ..., max_qubits. The times include the
+    // memory traffic and the arithmetic of the kernels on this machine (and
+    // number of threads) and serve as the cost model of set_fusion_costs().
+    // The simulated state is not modified.
+    std::vector<double> benchmark_kernels(unsigned num_qubits, unsigned max_qubits = 8,
+                                          unsigned repetitions = 3){
+        if (max_qubits < 1 || max_qubits > 8 || max_qubits > num_qubits || repetitions < 1)
+            throw(std::invalid_argument("benchmark_kernels(): Invalid number of qubits or repetitions."));
+        run();
+        StateVector state(std::size_t(1) << num_qubits);
+        calc_type const amplitude = std::sqrt(calc_type(1) / state.size());
+        #pragma omp parallel for schedule(static)
+        for (std::size_t i = 0; i < state.size(); ++i)
+            state[i] = amplitude;
+        std::swap(vec_, state);
+
+        std::vector<double> times;
+        for (unsigned k = 1; k <= max_qubits; ++k){
+            Fusion::Matrix m(1UL << k);
+            for (std::size_t r = 0; r < m.size(); ++r)
+                for (std::size_t c = 0; c < m.size(); ++c)
+                    m[r][c] = std::polar(1. / std::sqrt(m.size()), 0.1 * (r * c + 1));
+            // spread the qubits over the state (low and high bit indices)
+            std::vector<unsigned> ids(k);
+            for (unsigned l = 0; l < k; ++l)
+                ids[l] = l * (num_qubits - 1) / std::max(k - 1, 1u);
+            double best = 0.;
+            for (unsigned rep = 0; rep < repetitions; ++rep){
+                auto start = std::chrono::steady_clock::now();
+                apply_matrix(m, ids, 0, MATRIX_GENERAL);
+                double t = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                best = (rep == 0 ? t : std::min(best, t));
+            }
+            times.push_back(best);
+        }
+        std::swap(vec_, state);
+        return times;
+    }
+
+    // Sets the cost model of gate fusion: costs[k-1] is the time of applying
+    // a k-qubit gate (see benchmark_kernels()). Gates are then fused on up to
+    // costs.size() qubits, as long as applying the grown fused matrix is
+    // cheaper than applying the current one and the new gate separately. An
+    // empty vector restores the default policy (flush at 4 to 5 qubits).
+    void set_fusion_costs(std::vector<double> const& costs){
+        if (costs.size() > 8)
+            throw(std::invalid_argument("set_fusion_costs(): Gates with more than 8 qubits are not supported!"));
+        run();
+        fusion_costs_ = costs;
+    }
+
+    std::vector<double> const& get_fusion_costs() const{
+        return fusion_costs_;
+    }
+
+    // Lets the scheduler reorder windows of num_gates gates before fusing
+    // them (0 disables it, i.e., gates are fused in the order of arrival):
+    // commuting gates are grouped into clusters on as few qubits as possible,
+    // such that interleaved gates on different qubits do not break up the
+    // fused matrices. The gates are still only applied once run() is called
+    // (e.g. by measurements) or the window is full.
+    void set_lookahead(unsigned num_gates){
+        run();
+        lookahead_ = num_gates;
+    }
+
+    unsigned get_lookahead() const{
+        return lookahead_;
+    }
+
+    ~SimulatorT(){
+    }
+
+private:
+    void apply_term(Term const& term, std::vector<unsigned> const& ids,
+                    std::vector<unsigned> const& ctrl){
+        complex_type I(0., 1.);
+        Fusion::Matrix X = {{0., 1.}, {1., 0.}};
+        Fusion::Matrix Y = {{0., -I}, {I, 0.}};
+        Fusion::Matrix Z = {{1., 0.}, {0., -1.}};
+        std::vector<Fusion::Matrix> gates = {X, Y, Z};
+        for (auto const& local_op : term){
+            unsigned id = ids[local_op.first];
+            apply_controlled_gate(gates[local_op.second - 'X'], {id}, ctrl);
+        }
+        run();
+    }
+    // masks describing the action of a Pauli string on basis states:
+    // P|i> = i^num_y (-1)^popcount(i & phase) |i ^ flip>
+    struct PauliMasks{
+        std::size_t flip = 0;  // qubits acted on by X or Y
+        std::size_t phase = 0; // qubits acted on by Y or Z
+        unsigned num_y = 0;
+    };
+
+    PauliMasks get_pauli_masks(Term const& term, std::vector<unsigned> const& ids){
+        PauliMasks masks;
+        for (auto const& local_op : term){
+            if (local_op.first >= ids.size() || map_.count(ids[local_op.first]) == 0)
+                throw(std::runtime_error("Unknown qubit id in Pauli term. Please make sure you have called eng.flush()."));
+            std::size_t bit = 1UL << map_[ids[local_op.first]];
+            switch (local_op.second){
+                case 'X': masks.flip |= bit; break;
+                case 'Y': masks.flip |= bit; masks.phase |= bit; masks.num_y++; break;
+                case 'Z': masks.phase |= bit; break;
+                default:
+                    throw(std::invalid_argument("Invalid Pauli operator in term."));
+            }
+        }
+        return masks;
+    }
+
+    // Pauli strings grouped by their flip masks: {flip, [{phase, weight}]}
+    // where the weight includes the factor i^num_y
+    using PauliGroups = std::vector<std::pair<std::size_t,
+                                              std::vector<std::pair<std::size_t, complex_type>>>>;
+
+    PauliGroups group_pauli_terms(TermsDict const& td, std::vector<unsigned> const& ids,
+                                  calc_type scale = 1.){
+        complex_type I(0., 1.);
+        complex_type const powers_of_i[] = {1., I, -1., -I};
+        std::map<std::size_t, std::map<std::size_t, complex_type>> groups;
+        for (auto const& term : td){
+            auto masks = get_pauli_masks(term.first, ids);
+            groups[masks.flip][masks.phase] += scale * term.second * powers_of_i[masks.num_y % 4];
+        }
+        PauliGroups res;
+        for (auto const& group : groups)
+            res.emplace_back(group.first, std::vector<std::pair<std::size_t, complex_type>>(
+                                              group.second.begin(), group.second.end()));
+        return res;
+    }
+
+    // returns entry j of H*v for the grouped Pauli sum H (gather form)
+    static complex_type apply_pauli_groups(PauliGroups const& groups, StateVector const& v,
+                                           std::size_t j){
+        complex_type h = 0.;
+        for (auto const& group : groups){
+            auto const src = j ^ group.first;
+            complex_type w = 0.;
+            for (auto const& t : group.second)
+                w += parity(src & t.first) ? -t.second : t.second;
+            h += w * v[src];
+        }
+        return h;
+    }
+
+    // Bessel functions J_0(x), ..., J_K(x) for x >= 0 (Miller's backward
+    // recurrence), truncated after the last order K >= x with |J_K| >= tol.
+    // Computed in double also for the single-precision simulator, whose
+    // range is too small for the unnormalized recurrence.
+    static std::vector<double> bessel_j(double x, double tol){
+        if (x == 0.)
+            return {1.};
+        std::size_t M = static_cast<std::size_t>(x + 15. * std::cbrt(x) + 40.);
+        M += M % 2;
+        std::vector<double> J(M + 2, 0.);
+        J[M] = 1.e-30;
+        for (std::size_t k = M; k > 0; --k){
+            J[k-1] = 2. * k / x * J[k] - J[k+1];
+            if (std::abs(J[k-1]) > 1.e250){
+                for (std::size_t l = k - 1; l <= M; ++l)
+                    J[l] *= 1.e-250;
+            }
+        }
+        // normalize using J_0 + 2 * (J_2 + J_4 + ...) = 1
+        double nrm = J[0];
+        for (std::size_t k = 2; k <= M; k += 2)
+            nrm += 2. * J[k];
+        std::size_t K = M;
+        while (K > 0 && K > x && std::abs(J[K] / nrm) < tol)
+            --K;
+        J.resize(K + 1);
+        for (auto& j : J)
+            j /= nrm;
+        return J;
+    }
+
+    // multiplies each amplitude (with all control qubits set) by
+    // phase * exp(-i*time*E), where E = sum_k c_k (-1)^popcount(i & z_k) is
+    // its energy w.r.t. the Z-strings in `terms`; the phases are tabulated
+    // if the terms act on at most 16 qubits
+    void apply_diagonal_evolution(std::vector<std::pair<std::size_t, complex_type>> const& terms,
+                                  calc_type time, complex_type phase, std::size_t ctrlmask){
+        auto energy = [&terms](std::size_t i){
+            calc_type E = 0.;
+            for (auto const& t : terms)
+                E += parity(i & t.first) ? -std::real(t.second) : std::real(t.second);
+            return E;
+        };
+        std::size_t support = 0;
+        for (auto const& t : terms)
+            support |= t.first;
+        std::vector<unsigned> positions;
+        for (unsigned pos = 0; pos < N_; ++pos)
+            if ((support >> pos) & 1)
+                positions.push_back(pos);
+
+        if (positions.size() <= 16){
+            std::vector<complex_type> table(std::size_t(1) << positions.size());
+            for (std::size_t k = 0; k < table.size(); ++k)
+                table[k] = phase * std::polar(calc_type(1), -time * energy(deposit_bits(k, positions.data(), positions.size())));
+            #pragma omp parallel for schedule(static)
+            for (std::size_t i = 0; i < vec_.size(); ++i)
+                if ((i & ctrlmask) == ctrlmask)
+                    vec_[i] *= table[extract_bits(i, positions.data(), positions.size())];
+        }
+        else{
+            #pragma omp parallel for schedule(static)
+            for (std::size_t i = 0; i < vec_.size(); ++i)
+                if ((i & ctrlmask) == ctrlmask)
+                    vec_[i] *= phase * std::polar(calc_type(1), -time * energy(i));
+        }
+    }
+
+    // exp(-i*theta*P) = cos(theta) - i*sin(theta) P maps the pair (i, i^flip) to
+    //   (c psi[i] + s sgn(i^flip) psi[i^flip], c psi[i^flip] + s sgn(i) psi[i])
+    // with c = cos(theta), s = -i*sin(theta)*i^num_y, sgn(i) = (-1)^popcount(i & phase)
+    struct PauliRotation{
+        std::size_t flip, low, phase;
+        complex_type c, s;
+
+        PauliRotation(PauliMasks const& masks, calc_type theta)
+        : flip(masks.flip), low(masks.flip & (~masks.flip + 1)), phase(masks.phase),
+          c(std::cos(theta)), s(0., -std::sin(theta)){
+            complex_type I(0., 1.);
+            for (unsigned k = 0; k < masks.num_y % 4; ++k)
+                s *= I;
+        }
+
+        complex_type sgn(std::size_t i) const{
+            return parity(i & phase) ? -s : s;
+        }
+    };
+
+    // applies rotations[begin, end) to blocks of the state spanned by the
+    // flipped qubits (padded with low-order qubits) one block at a time
+    void apply_pauli_rotation_block(TermsDict const& rotations, std::vector<PauliMasks> const& masks,
+                                    std::size_t begin, std::size_t end, std::size_t flips,
+                                    std::size_t ctrlmask){
+        std::vector<unsigned> positions;
+        for (unsigned pos = 0; pos < N_; ++pos)
+            if (((flips | ctrlmask) >> pos & 1) == 0 && popcount(flips) + positions.size() < min_block_qubits_)
+                positions.push_back(pos);
+        for (unsigned pos = 0; pos < N_; ++pos)
+            if ((flips >> pos) & 1)
+                positions.push_back(pos);
+        std::sort(positions.begin(), positions.end());
+        std::size_t const block = std::size_t(1) << positions.size();
+        std::vector<std::size_t> offsets(block);
+        for (std::size_t k = 0; k < block; ++k)
+            offsets[k] = deposit_bits(k, positions.data(), positions.size());
+
+        std::vector<PauliRotation> rots;
+        std::vector<std::size_t> local_flips, local_lows;
+        for (std::size_t r = begin; r < end; ++r){
+            rots.emplace_back(masks[r], rotations[r].second);
+            local_flips.push_back(extract_bits(masks[r].flip, positions.data(), positions.size()));
+            local_lows.push_back(local_flips.back() & (~local_flips.back() + 1));
+        }
+
+        #pragma omp parallel for schedule(static)
+        for (std::size_t outer = 0; outer < (vec_.size() >> positions.size()); ++outer){
+            std::size_t base = insert_zero_bits(outer, positions.data(), positions.size());
+            if ((base & ctrlmask) != ctrlmask)
+                continue;
+            for (std::size_t r = 0; r < rots.size(); ++r){
+                auto const& rot = rots[r];
+                if (rot.flip == 0){
+                    for (std::size_t k = 0; k < block; ++k){
+                        auto i = base | offsets[k];
+                        vec_[i] *= rot.c + rot.sgn(i);
+                    }
+                    continue;
+                }
+                for (std::size_t k = 0; k < block; ++k){
+                    if (k & local_lows[r])
+                        continue;
+                    auto i = base | offsets[k];
+                    auto j = base | offsets[k ^ local_flips[r]];
+                    auto const vi = vec_[i], vj = vec_[j];
+                    vec_[i] = rot.c * vi + rot.sgn(j) * vj;
+                    vec_[j] = rot.c * vj + rot.sgn(i) * vi;
+                }
+            }
+        }
+    }
+
+    // applies a single rotation exp(-i*theta*P) in one sweep over all pairs
+    void apply_pauli_rotation(PauliMasks const& masks, calc_type theta, std::size_t ctrlmask){
+        PauliRotation rot(masks, theta);
+        unsigned low_pos = 0;
+        while ((rot.low >> low_pos) != 1)
+            ++low_pos;
+        #pragma omp parallel for schedule(static)
+        for (std::size_t k = 0; k < (vec_.size() >> 1); ++k){
+            auto i = insert_zero_bits(k, &low_pos, 1);
+            if ((i & ctrlmask) != ctrlmask)
+                continue;
+            auto j = i ^ rot.flip;
+            auto const vi = vec_[i], vj = vec_[j];
+            vec_[i] = rot.c * vi + rot.sgn(j) * vj;
+            vec_[j] = rot.c * vj + rot.sgn(i) * vi;
+        }
+    }
+
+    // positions of the qubits of a quantum register in the state vector index
+    // (bit k of the register value is bit positions[k] of the index)
+    struct RegisterLayout{
+        std::vector<unsigned> positions;
+        std::size_t mask = 0;
+        bool ascending = true; // use pext/pdep
+
+        std::uint64_t value(std::size_t i) const{
+            if (ascending)
+                return gather_bits(i, mask);
+            return extract_bits(i, positions.data(), positions.size());
+        }
+
+        // returns i with the register value replaced by x
+        std::size_t assign(std::size_t i, std::uint64_t x) const{
+            if (ascending)
+                return (i & ~mask) | scatter_bits(x, mask);
+            return (i & ~mask) | deposit_bits(x, positions.data(), positions.size());
+        }
+    };
+
+    RegisterLayout get_register_layout(std::vector<unsigned> const& qureg){
+        RegisterLayout layout;
+        for (auto id : qureg){
+            auto pos = map_[id];
+            layout.ascending &= layout.positions.empty() || pos > layout.positions.back();
+            layout.positions.push_back(pos);
+            layout.mask |= std::size_t(1) << pos;
+        }
+        return layout;
+    }
+
+    // returns true if a non-zero amplitude with all controls set has a
+    // register value >= min_value
+    bool has_register_values(RegisterLayout const& layout, std::size_t ctrlmask, std::uint64_t min_value){
+        if (min_value >= (std::uint64_t(1) << layout.positions.size()))
+            return false;
+        int found = 0;
+        #pragma omp parallel for schedule(static) reduction(|:found)
+        for (std::size_t i = 0; i < vec_.size(); ++i){
+            if ((i & ctrlmask) == ctrlmask && layout.value(i) >= min_value && vec_[i] != complex_type(0))
+                found = 1;
+        }
+        return found != 0;
+    }
+
+    // positions excluded from the enumeration of the remaining qubits (the
+    // register and the controls), see rest_index()
+    std::vector<unsigned> rest_positions(RegisterLayout const& layout, std::size_t ctrlmask){
+        std::vector<unsigned> positions = layout.positions;
+        for (unsigned pos = 0; pos < N_; ++pos)
+            if ((ctrlmask >> pos) & 1)
+                positions.push_back(pos);
+        std::sort(positions.begin(), positions.end());
+        return positions;
+    }
+
+    // moves the amplitude of register value x to the value f(x) in place for
+    // all basis states where the controls are 1: the cycles of f are given by
+    // their leaders, finv is the inverse of f (cycle following)
+    template <class Leader, class InverseMap>
+    void permute_register(RegisterLayout const& layout, std::size_t ctrlmask, std::size_t num_cycles,
+                          Leader const& leader, InverseMap const& finv){
+        auto positions = rest_positions(layout, ctrlmask);
+        std::size_t const num_rest = vec_.size() >> positions.size();
+        auto follow = [&](std::size_t rest, std::uint64_t first){
+            auto tmp = vec_[layout.assign(rest, first)];
+            auto x = first;
+            for (auto src = finv(x); src != first; x = src, src = finv(x))
+                vec_[layout.assign(rest, x)] = vec_[layout.assign(rest, src)];
+            vec_[layout.assign(rest, x)] = tmp;
+        };
+        if (num_rest >= 64){
+            #pragma omp parallel for schedule(static)
+            for (std::size_t k = 0; k < num_rest; ++k){
+                auto rest = insert_zero_bits(k, positions.data(), positions.size()) | ctrlmask;
+                for (std::size_t c = 0; c < num_cycles; ++c)
+                    follow(rest, leader(c));
+            }
+        }
+        else{
+            for (std::size_t k = 0; k < num_rest; ++k){
+                auto rest = insert_zero_bits(k, positions.data(), positions.size()) | ctrlmask;
+                #pragma omp parallel for schedule(dynamic, 64)
+                for (std::size_t c = 0; c < num_cycles; ++c)
+                    follow(rest, leader(c));
+            }
+        }
+    }
+
+    // maps register value x < L to (x + shift) mod L in place (values >= L
+    // are left unchanged); if there are only few basis states of the other
+    // qubits, the rotation is done by three (parallel) reversals instead of
+    // following its gcd(shift, L) cycles
+    void rotate_register(RegisterLayout const& layout, std::size_t ctrlmask, std::uint64_t L,
+                         std::uint64_t shift){
+        if (shift == 0)
+            return;
+        auto positions = rest_positions(layout, ctrlmask);
+        std::size_t const num_rest = vec_.size() >> positions.size();
+        if (num_rest >= 64){
+            permute_register(layout, ctrlmask, gcd(shift, L),
+                             [](std::size_t c){ return std::uint64_t(c); },
+                             [L, shift](std::uint64_t x){ return x >= shift ? x - shift : x + L - shift; });
+            return;
+        }
+        for (std::size_t k = 0; k < num_rest; ++k){
+            auto rest = insert_zero_bits(k, positions.data(), positions.size()) | ctrlmask;
+            reverse_register(layout, rest, 0, L);
+            reverse_register(layout, rest, 0, shift);
+            reverse_register(layout, rest, shift, L);
+        }
+    }
+
+    // reverses the order of the amplitudes of the register values [lo, hi)
+    void reverse_register(RegisterLayout const& layout, std::size_t rest,
+                          std::uint64_t lo, std::uint64_t hi){
+        std::uint64_t const half = (hi - lo) / 2;
+        #pragma omp parallel for schedule(static)
+        for (std::uint64_t t = 0; t < half; ++t)
+            std::swap(vec_[layout.assign(rest, lo + t)], vec_[layout.assign(rest, hi - 1 - t)]);
+    }
+
+    template <class Int>
+    static Int gcd(Int a, Int b){
+        while (b != 0){
+            Int t = a % b;
+            a = b;
+            b = t;
+        }
+        return a;
+    }
+
+    // inverse of a modulo N (a and N must be coprime)
+    static std::int64_t mod_inverse(std::int64_t a, std::int64_t N){
+        std::int64_t r0 = N, r1 = a, t0 = 0, t1 = 1;
+        while (r1 != 0){
+            std::int64_t q = r0 / r1, tmp;
+            tmp = r0 - q * r1; r0 = r1; r1 = tmp;
+            tmp = t0 - q * t1; t0 = t1; t1 = tmp;
+        }
+        return ((t0 % N) + N) % N;
+    }
+
+    // applies the fused matrix and the collected diagonal gates
+    void apply_fused_gates(){
         if (fused_gates_.size() < 1)
             return;
 
+        if (fused_gates_.num_qubits() > 0)
+            apply_fused_matrix();
+        if (fused_gates_.diagonal_items().size() > 0)
+            apply_diagonal_items();
+
+        fused_gates_.clear();
+    }
+
+    // Passes the gates of the scheduler window on to Fusion in clusters: a
+    // gate joins the current fused matrix if all gates it depends on have
+    // been emitted and the matrix stays within the fusion limit (or the cost
+    // model says so). Diagonal gates are collected as usual. Once no gate
+    // fits, the fused matrix is applied (the diagonal gates stay pending,
+    // unless they block all remaining gates).
+    void schedule_gates(){
+        auto try_emit = [this](GateScheduler::Gate& gate){
+            if (gate.diagonal){
+                fused_gates_.insert_diagonal(gate.matrix, gate.ids, gate.ctrl);
+                return true;
+            }
+            if (!fused_gates_.commutes_with_diagonal(gate.ids))
+                return false;
+            // without a cost model, the matrix only grows until it has at
+            // least fusion_qubits_min_ qubits (like in apply_controlled_gate)
+            unsigned current = fused_gates_.num_qubits();
+            unsigned num_qubits = fused_gates_.num_qubits_if_inserted(gate.ids, gate.ctrl);
+            bool fits;
+            if (fusion_costs_.size() > 0)
+                fits = extend_fusion(num_qubits, gate.ids.size());
+            else
+                fits = num_qubits <= (current < fusion_qubits_min_ ? fusion_qubits_max_ : current);
+            if (current > 0 && !fits)
+                return false;
+            fused_gates_.insert(std::move(gate.matrix), gate.ids, gate.ctrl);
+            return true;
+        };
+        auto close_cluster = [this](){
+            if (fused_gates_.num_qubits() > 0){
+                apply_fused_matrix();
+                fused_gates_.clear_matrix();
+            }
+            else
+                apply_fused_gates();
+        };
+        scheduler_.drain(try_emit, close_cluster);
+    }
+
+    // applies the fused (non-diagonal) gates using the kernel for the
+    // corresponding number of qubits and structure of the matrix
+    void apply_fused_matrix(){
         Fusion::Matrix m;
         Fusion::IndexVector ids, ctrls;
 
         fused_gates_.perform_fusion(m, ids, ctrls);
 
+        // fold a pending normalization factor into the gate (if it acts on
+        // all amplitudes)
+        if (norm_factor_ != 1.){
+            if (ctrls.size() == 0){
+                for (std::size_t k = 0; k < m.size() * m.size(); ++k)
+                    m.data()[k] *= norm_factor_;
+                norm_factor_ = 1.;
+            }
+            else
+                normalize();
+        }
+
         for (auto& id : ids)
             id = map_[id];
 
         auto ctrlmask = get_control_mask(ctrls);
 
+        // pick the kernel according to the structure of the matrix
+        MatrixStructure structure = MATRIX_GENERAL;
+        if (is_monomial(m))
+            structure = MATRIX_MONOMIAL;
+        else if (is_real(m))
+            structure = MATRIX_REAL;
+
+        apply_matrix(m, ids, ctrlmask, structure);
+    }
+
+    enum MatrixStructure { MATRIX_GENERAL, MATRIX_REAL, MATRIX_MONOMIAL };
+
+    // applies the matrix m to the qubits at the bit positions ids using the
+    // kernel for the corresponding number of qubits
+    void apply_matrix(Fusion::Matrix const& m, std::vector<unsigned> const& ids,
+                      std::size_t ctrlmask, MatrixStructure structure){
         switch (ids.size()){
             case 1:
-                #pragma omp parallel
-                kernel(vec_, ids[0], m, ctrlmask);
+                apply_kernel<1>(m, ids.data(), ctrlmask, structure);
                 break;
             case 2:
-                #pragma omp parallel
-                kernel(vec_, ids[1], ids[0], m, ctrlmask);
+                apply_kernel<2>(m, ids.data(), ctrlmask, structure);
                 break;
             case 3:
-                #pragma omp parallel
-                kernel(vec_, ids[2], ids[1], ids[0], m, ctrlmask);
+                apply_kernel<3>(m, ids.data(), ctrlmask, structure);
                 break;
             case 4:
-                #pragma omp parallel
-                kernel(vec_, ids[3], ids[2], ids[1], ids[0], m, ctrlmask);
+                apply_kernel<4>(m, ids.data(), ctrlmask, structure);
                 break;
             case 5:
-                #pragma omp parallel
-                kernel(vec_, ids[4], ids[3], ids[2], ids[1], ids[0], m, ctrlmask);
+                apply_kernel<5>(m, ids.data(), ctrlmask, structure);
+                break;
+            case 6:
+                apply_kernel<6>(m, ids.data(), ctrlmask, structure);
+                break;
+            case 7:
+                apply_kernel<7>(m, ids.data(), ctrlmask, structure);
+                break;
+            case 8:
+                apply_kernel<8>(m, ids.data(), ctrlmask, structure);
                 break;
             default:
-                throw std::invalid_argument("Gates with more than 5 qubits are not supported!");
+                throw std::invalid_argument("Gates with more than 8 qubits are not supported!");
         }
+    }
 
-        fused_gates_ = Fusion();
+    // cost model of gate fusion (see set_fusion_costs()): adding a gate on
+    // k qubits grows the fused matrix to num_qubits qubits
+    bool extend_fusion(unsigned num_qubits, unsigned k) const{
+        unsigned current = fused_gates_.num_qubits();
+        if (current == 0)
+            return true;
+        if (num_qubits > fusion_costs_.size())
+            return false;
+        return fusion_costs_[num_qubits - 1] <= fusion_costs_[current - 1] + fusion_costs_[k - 1];
     }
 
-    std::tuple<Map, StateVector&> cheat(){
-        run();
-        return make_tuple(map_, std::ref(vec_));
+    // applies the 2^K x 2^K matrix m, using the specialized kernels for
+    // monomial matrices (permutations with phases, which need no
+    // multiplications at all if the phases are 1) and real matrices (half
+    // the multiplications of the general kernel) for the selected
+    // instruction set
+    template <unsigned K>
+    void apply_kernel(Fusion::Matrix const& m, unsigned const* ids, std::size_t ctrlmask,
+                      MatrixStructure structure){
+        if (structure == MATRIX_MONOMIAL)
+            return kernel_monomial<K>(vec_, ids, m, ctrlmask);
+        bool real = (structure == MATRIX_REAL);
+#if defined(INTRIN) && !defined(NOINTRIN)
+        if (kernel_level_ == 2){
+            if (real)
+                return avx512::kernel_real<K>(vec_, ids, m, ctrlmask);
+            return avx512::kernel<K>(vec_, ids, m, ctrlmask);
+        }
+        if (kernel_level_ == 1){
+            if (real)
+                return avx2::kernel_real<K>(vec_, ids, m, ctrlmask);
+            return avx2::kernel<K>(vec_, ids, m, ctrlmask);
+        }
+#endif
+        if (real)
+            return scalar::kernel_real<K>(vec_, ids, m, ctrlmask);
+        scalar::kernel<K>(vec_, ids, m, ctrlmask);
     }
 
-    ~Simulator(){
+    static char const* const* kernel_names(){
+        static char const* const names[] = {"scalar", "avx2", "avx512"};
+        return names;
     }
 
-private:
-    void apply_term(Term const& term, std::vector<unsigned> const& ids,
-                    std::vector<unsigned> const& ctrl){
-        complex_type I(0., 1.);
-        Fusion::Matrix X = {{0., 1.}, {1., 0.}};
-        Fusion::Matrix Y = {{0., -I}, {I, 0.}};
-        Fusion::Matrix Z = {{1., 0.}, {0., -1.}};
-        std::vector<Fusion::Matrix> gates = {X, Y, Z};
-        for (auto const& local_op : term){
-            unsigned id = ids[local_op.first];
-            apply_controlled_gate(gates[local_op.second - 'X'], {id}, ctrl);
+    // highest kernel level supported by the CPU and the build
+    static unsigned max_kernel_level(){
+#if defined(INTRIN) && !defined(NOINTRIN)
+        return cpu_kernel_level();
+#else
+        return 0;
+#endif
+    }
+
+    // multiplies each amplitude by the product of the collected diagonal
+    // gates, i.e., by one tabulated phase per diagonal item
+    void apply_diagonal_items(){
+        auto const& items = fused_gates_.diagonal_items();
+        std::vector<std::uint64_t> masks(items.size(), 0);
+        std::vector<std::vector<complex_type>> tables(items.size());
+        for (std::size_t t = 0; t < items.size(); ++t){
+            auto const& idx = items[t].get_indices();
+            auto const& diag = items[t].get_diagonal();
+            std::vector<unsigned> positions(idx.size());
+            for (std::size_t l = 0; l < idx.size(); ++l){
+                positions[l] = map_[idx[l]];
+                masks[t] |= std::uint64_t(1) << positions[l];
+            }
+            // re-order the table such that it is indexed by the gathered bits
+            tables[t].resize(diag.size());
+            for (std::size_t k = 0; k < diag.size(); ++k)
+                tables[t][gather_bits(deposit_bits(k, positions.data(), positions.size()), masks[t])] = diag[k];
         }
-        run();
+        // fold a pending normalization factor into the phases
+        for (auto& entry : tables[0])
+            entry *= norm_factor_;
+        norm_factor_ = 1.;
+
+        #pragma omp parallel for schedule(static)
+        for (std::size_t i = 0; i < vec_.size(); ++i){
+            complex_type phase = tables[0][gather_bits(i, masks[0])];
+            for (std::size_t t = 1; t < tables.size(); ++t)
+                phase *= tables[t][gather_bits(i, masks[t])];
+            vec_[i] *= phase;
+        }
+    }
+
+    // takes back the state vector lent out by cheat() before it is modified,
+    // or copies it if it is still referenced elsewhere
+    void reclaim_state(){
+        if (!lent_state_)
+            return;
+        if (lent_state_.use_count() == 1)
+            vec_ = std::move(*lent_state_);
+        else{
+            StateVector const& lent = *lent_state_;
+            vec_ = buffers_.acquire(std::max(lent.size(), reserved_size_));
+            vec_.resize(lent.size());
+            #pragma omp parallel for schedule(static)
+            for (std::size_t i = 0; i < lent.size(); ++i)
+                vec_[i] = lent[i];
+        }
+        lent_state_.reset();
+    }
+
+    // applies a pending normalization factor to the state vector
+    void normalize(){
+        if (norm_factor_ == 1.)
+            return;
+        #pragma omp parallel for schedule(static)
+        for (std::size_t i = 0; i < vec_.size(); ++i)
+            vec_[i] *= norm_factor_;
+        norm_factor_ = 1.;
+    }
+
+    // picks a basis state at random with probability |amplitude|^2: the
+    // probabilities of num_blocks_ blocks of the state are summed up in
+    // parallel, only the selected block is scanned serially
+    std::size_t sample_index(){
+        double rnd = rng_() / (norm_factor_ * norm_factor_);
+        std::size_t num_blocks = std::min(vec_.size(), std::size_t(num_blocks_));
+        std::size_t block = vec_.size() / num_blocks;
+        std::vector<double> P(num_blocks, 0.);
+        #pragma omp parallel for schedule(static)
+        for (std::size_t b = 0; b < num_blocks; ++b)
+            for (std::size_t i = b * block; i < (b + 1) * block; ++i)
+                P[b] += std::norm(vec_[i]);
+
+        double acc = 0.;
+        std::size_t b = 0;
+        while (b + 1 < num_blocks && acc + P[b] < rnd)
+            acc += P[b++];
+        std::size_t pick = b * block;
+        while (pick + 1 < (b + 1) * block && (acc += std::norm(vec_[pick])) < rnd)
+            pick++;
+        return pick;
     }
+
+    // cumulative probabilities of all basis states (blocked parallel prefix sum)
+    std::vector<double> cumulative_probabilities(){
+        std::size_t num_blocks = std::min(vec_.size(), std::size_t(num_blocks_));
+        std::size_t block = vec_.size() / num_blocks;
+        std::vector<double> cdf(vec_.size());
+        std::vector<double> offsets(num_blocks + 1, 0.);
+        #pragma omp parallel for schedule(static)
+        for (std::size_t b = 0; b < num_blocks; ++b){
+            double P = 0.;
+            for (std::size_t i = b * block; i < (b + 1) * block; ++i)
+                cdf[i] = (P += std::norm(vec_[i]));
+            offsets[b + 1] = P;
+        }
+        std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+        #pragma omp parallel for schedule(static)
+        for (std::size_t b = 1; b < num_blocks; ++b)
+            for (std::size_t i = b * block; i < (b + 1) * block; ++i)
+                cdf[i] += offsets[b];
+        return cdf;
+    }
+
+    // cumulative probabilities of the outcomes of measuring the qubits at the
+    // given positions (marginal distribution), histograms are accumulated
+    // per block and summed up afterwards
+    std::vector<double> cumulative_probabilities(std::vector<unsigned> const& positions){
+        std::size_t num_outcomes = std::size_t(1) << positions.size();
+        std::size_t num_blocks = std::min(vec_.size(), std::size_t(num_blocks_));
+        std::size_t block = vec_.size() / num_blocks;
+        std::vector<double> hist(num_blocks * num_outcomes, 0.);
+        #pragma omp parallel for schedule(static)
+        for (std::size_t b = 0; b < num_blocks; ++b){
+            double* h = &hist[b * num_outcomes];
+            for (std::size_t i = b * block; i < (b + 1) * block; ++i)
+                h[extract_bits(i, positions.data(), positions.size())] += std::norm(vec_[i]);
+        }
+        std::vector<double> cdf(num_outcomes, 0.);
+        #pragma omp parallel for schedule(static)
+        for (std::size_t k = 0; k < num_outcomes; ++k)
+            for (std::size_t b = 0; b < num_blocks; ++b)
+                cdf[k] += hist[b * num_outcomes + k];
+        std::partial_sum(cdf.begin(), cdf.end(), cdf.begin());
+        return cdf;
+    }
+
+    // removes the given qubits from the state vector, keeping the amplitudes
+    // where their bits match those in value (optionally renormalized)
+    void remove_qubits(std::vector<unsigned> const& ids, std::size_t value,
+                       bool renormalize = false){
+        std::vector<unsigned> positions;
+        for (auto id : ids)
+            positions.push_back(map_[id]);
+        std::sort(positions.begin(), positions.end());
+        if (std::adjacent_find(positions.begin(), positions.end()) != positions.end())
+            throw(std::runtime_error("DeallocateQubit: Qubit IDs should be unique."));
+
+        // free the cached buffers of the larger state first, such that they
+        // are not recycled for the smaller one
+        update_buffer_limit(N_ - ids.size());
+        auto newvec = buffers_.acquire(vec_.size() >> ids.size()); // avoid costly memory reallocations
+        double N = 0.;
+        #pragma omp parallel for schedule(static) reduction(+:N)
+        for (std::size_t j = 0; j < newvec.size(); ++j){
+            auto const& a = vec_[insert_zero_bits(j, positions.data(), positions.size()) | value];
+            newvec[j] = a;
+            N += std::norm(a);
+        }
+        if (renormalize)
+            norm_factor_ = 1./std::sqrt(N); // deferred to the next gate
+        std::swap(vec_, newvec);
+        buffers_.release(std::move(newvec));
+
+        for (auto id : ids)
+            map_.erase(id);
+        for (auto& p : map_)
+            p.second -= std::lower_bound(positions.begin(), positions.end(), p.second) - positions.begin();
+        N_ -= ids.size();
+    }
+
     std::size_t get_control_mask(std::vector<unsigned> const& ctrls){
         std::size_t ctrlmask = 0;
         for (auto c : ctrls)
@@ -554,6 +1709,19 @@ private:
         return ctrlmask;
     }
 
+    // by default, the scratch buffers cached by the pool hold at most one
+    // state vector of num_qubits qubits (or the reserved size, or the
+    // buffers requested by reserve_buffers), such that the peak memory is
+    // about twice the size of the state vector; buffers of a larger state
+    // are freed once qubits are deallocated
+    void update_buffer_limit(unsigned num_qubits){
+        if (!auto_buffer_limit_)
+            return;
+        std::size_t state = std::max(std::size_t(1) << num_qubits, reserved_size_);
+        buffers_.set_max_bytes(std::max(state * sizeof(complex_type),
+                                        reserved_buffer_bytes_));
+    }
+
     bool check_ids(std::vector<unsigned> const& ids){
         for (auto id : ids)
             if (!map_.count(id))
@@ -563,17 +1731,30 @@ private:
 
     unsigned N_; // #qubits
     StateVector vec_;
+    std::shared_ptr<StateVector> lent_state_; // state vector lent out by cheat()
+    std::size_t reserved_size_; // reserved state vector size
+    // the state is norm_factor_ * vec_: re-normalization after measurements
+    // is folded into the next gate instead of requiring an extra sweep
+    calc_type norm_factor_;
     Map map_;
     Fusion fused_gates_;
     unsigned fusion_qubits_min_, fusion_qubits_max_;
+    std::vector<double> fusion_costs_; // cost model of gate fusion (if set)
+    unsigned lookahead_; // size of the window of the gate scheduler (0: off)
+    GateScheduler scheduler_;
+    unsigned kernel_level_; // 0: scalar, 1: AVX2, 2: AVX-512 kernels
     RndEngine rnd_eng_;
     std::function<double()> rng_;
+    static constexpr std::size_t num_blocks_ = 256; // for parallel prefix sums
+    // qubits spanned by the cache blocks of apply_pauli_rotations
+    static constexpr unsigned min_block_qubits_ = 10, max_block_qubits_ = 12;
 
     // large array buffers to avoid costly reallocations
-    static StateVector tmpBuff1_, tmpBuff2_;
+    BufferPool<StateVector> buffers_;
+    bool auto_buffer_limit_; // limit of buffers_ follows the state size
+    std::size_t reserved_buffer_bytes_; // requested by reserve_buffers
 };
 
-Simulator::StateVector Simulator::tmpBuff1_;
-Simulator::StateVector Simulator::tmpBuff2_;
+using Simulator = SimulatorT<double>;
 
 #endif
@@ -17,6 +17,7 @@
 #include <pybind11/pytypes.h>
 #include <vector>
 #include <complex>
+#include <memory>
 #include <iostream>
 #if defined(_OPENMP)
 #include <omp.h>
@@ -30,8 +31,8 @@ using ArrayType = std::vector<c_type, aligned_allocator<c_type,64>>;
 using MatrixType = std::vector<ArrayType>;
 using QuRegs = std::vector<std::vector<unsigned>>;
 
-template <class QR>
-void emulate_math_wrapper(Simulator &sim, py::function const& pyfunc, QR const& qr, std::vector<unsigned> const& ctrls){
+template <class Sim, class QR>
+void emulate_math_wrapper(Sim &sim, py::function const& pyfunc, QR const& qr, std::vector<unsigned> const& ctrls){
     auto f = [&](std::vector<int>& x) {
         pybind11::gil_scoped_acquire acquire;
         x = std::move(pyfunc(x).cast<std::vector<int>>());
@@ -39,29 +40,144 @@ void emulate_math_wrapper(Simulator &sim, py::function const& pyfunc, QR const&
     pybind11::gil_scoped_release release;
     sim.emulate_math(f, qr, ctrls);
 }
-PYBIND11_PLUGIN(_cppsim) {
-    py::module m("_cppsim", "_cppsim");
-    py::class_<Simulator>(m, "Simulator")
+template <class Sim, class QR>
+void emulate_math_table_wrapper(Sim &sim, py::array_t<std::uint64_t, py::array::c_style | py::array::forcecast> const& table,
+                                QR const& qr, std::vector<unsigned> const& ctrls){
+    std::vector<std::uint64_t> tab(table.data(), table.data() + table.size());
+    pybind11::gil_scoped_release release;
+    sim.emulate_math_table(tab, qr, ctrls);
+}
+// the gate matrices are passed in double precision to both simulators
+template <class Sim>
+std::vector<bool> apply_commands_wrapper(Sim &sim, std::vector<unsigned> const& program,
+                                         py::array_t<c_type, py::array::c_style | py::array::forcecast> const& matrices){
+    std::vector<bool> results;
+    c_type const* data = matrices.data();
+    std::size_t num_entries = matrices.size();
+    pybind11::gil_scoped_release release;
+    sim.apply_commands(program, data, num_entries, results);
+    return results;
+}
+// Returns the qubit map and the state vector as a read-only NumPy array
+// without copying the amplitudes. The array shares the buffer lent out by
+// the simulator (see SimulatorT::cheat), i.e., it stays valid as long as it
+// exists, while the simulator continues on its own copy if the array is
+// still alive at the next operation.
+template <class Sim>
+py::tuple cheat_wrapper(Sim &sim){
+    using complex_type = typename Sim::complex_type;
+    using SharedState = std::shared_ptr<typename Sim::StateVector const>;
+    typename Sim::Map map;
+    SharedState state;
+    {
+        pybind11::gil_scoped_release release;
+        std::tie(map, state) = sim.cheat();
+    }
+    auto owner = new SharedState(state);
+    py::capsule base(owner, [](void* p){ delete static_cast<SharedState*>(p); });
+    py::array_t<complex_type> array({state->size()}, {sizeof(complex_type)}, state->data(), base);
+    array.attr("flags").attr("writeable") = false;
+    return py::make_tuple(map, array);
+}
+
+// the wavefunction is converted to the precision of the simulator by NumPy
+template <class Sim>
+void set_wavefunction_wrapper(Sim &sim,
+                              py::array_t<typename Sim::complex_type, py::array::c_style | py::array::forcecast> const& wavefunction,
+                              std::vector<unsigned> const& ordering){
+    if (wavefunction.ndim() != 1)
+        throw std::runtime_error("set_wavefunction(): The wavefunction must be a one-dimensional array.");
+    auto const* data = wavefunction.data();
+    std::size_t size = wavefunction.size();
+    pybind11::gil_scoped_release release;
+    sim.set_wavefunction(data, size, ordering);
+}
+
+// Returns the sampled outcomes as a NumPy array of unsigned 64-bit integers
+template <class Sim>
+py::array_t<std::uint64_t> sample_wrapper(Sim &sim, std::vector<unsigned> const& ids, std::size_t shots){
+    std::vector<std::uint64_t> samples;
+    {
+        pybind11::gil_scoped_release release;
+        samples = sim.sample(ids, shots);
+    }
+    return py::array_t<std::uint64_t>(samples.size(), samples.data());
+}
+
+template <class Sim>
+py::dict buffer_statistics_wrapper(Sim const& sim){
+    auto const& stats = sim.get_buffer_statistics();
+    py::dict d;
+    d["hits"] = stats.hits;
+    d["misses"] = stats.misses;
+    d["releases"] = stats.releases;
+    d["bytes_held"] = stats.bytes_held;
+    d["peak_bytes_held"] = stats.peak_bytes_held;
+    return d;
+}
+
+// exports the simulator computing in double (Sim = Simulator) or single
+// precision (Sim = SimulatorT<float>) under the given name
+template <class Sim>
+void bind_simulator(py::module &m, char const* name){
+    // all calls which may sweep the state vector release the GIL such that
+    // different simulator instances can be used from different Python threads
+    // concurrently (a single instance must not be shared between threads)
+    using release_gil = py::call_guard<py::gil_scoped_release>;
+    py::class_<Sim>(m, name)
         .def(py::init<unsigned>())
-        .def("allocate_qubit", &Simulator::allocate_qubit)
-        .def("deallocate_qubit", &Simulator::deallocate_qubit)
-        .def("get_classical_value", &Simulator::get_classical_value)
-        .def("is_classical", &Simulator::is_classical)
-        .def("measure_qubits", &Simulator::measure_qubits_return)
-        .def("apply_controlled_gate", &Simulator::apply_controlled_gate<MatrixType>)
-        .def("emulate_math", &emulate_math_wrapper<QuRegs>)
-        .def("emulate_math_addConstant", &Simulator::emulate_math_addConstant<QuRegs>)
-        .def("emulate_math_addConstantModN", &Simulator::emulate_math_addConstantModN<QuRegs>)
-        .def("emulate_math_multiplyByConstantModN", &Simulator::emulate_math_multiplyByConstantModN<QuRegs>)
-        .def("get_expectation_value", &Simulator::get_expectation_value)
-        .def("apply_qubit_operator", &Simulator::apply_qubit_operator)
-        .def("emulate_time_evolution", &Simulator::emulate_time_evolution)
-        .def("get_probability", &Simulator::get_probability)
-        .def("get_amplitude", &Simulator::get_amplitude)
-        .def("set_wavefunction", &Simulator::set_wavefunction)
-        .def("collapse_wavefunction", &Simulator::collapse_wavefunction)
-        .def("run", &Simulator::run)
-        .def("cheat", &Simulator::cheat)
+        .def("allocate_qubit", &Sim::allocate_qubit, release_gil())
+        .def("allocate_qubits", &Sim::allocate_qubits, release_gil())
+        .def("reserve", &Sim::reserve, release_gil())
+        .def("deallocate_qubit", &Sim::deallocate_qubit, release_gil())
+        .def("deallocate_qubits", &Sim::deallocate_qubits, py::arg("ids"),
+             py::arg("tol") = 1.e-12, release_gil())
+        .def("measure_and_release", &Sim::measure_and_release, release_gil())
+        .def("get_classical_value", &Sim::get_classical_value, release_gil())
+        .def("is_classical", &Sim::is_classical, release_gil())
+        .def("measure_qubits", &Sim::measure_qubits_return, release_gil())
+        .def("sample", &sample_wrapper<Sim>)
+        .def("apply_controlled_gate", &Sim::template apply_controlled_gate<MatrixType>, release_gil())
+        .def("apply_commands", &apply_commands_wrapper<Sim>)
+        .def("emulate_math", &emulate_math_wrapper<Sim, QuRegs>)
+        .def("emulate_math_table", &emulate_math_table_wrapper<Sim, QuRegs>)
+        .def("emulate_math_addConstant", &Sim::template emulate_math_addConstant<QuRegs>, release_gil())
+        .def("emulate_math_addConstantModN", &Sim::template emulate_math_addConstantModN<QuRegs>, release_gil())
+        .def("emulate_math_multiplyByConstantModN", &Sim::template emulate_math_multiplyByConstantModN<QuRegs>, release_gil())
+        .def("get_expectation_value", &Sim::get_expectation_value, release_gil())
+        .def("apply_qubit_operator", &Sim::apply_qubit_operator, release_gil())
+        .def("emulate_time_evolution", &Sim::emulate_time_evolution,
+             py::arg("terms_dict"), py::arg("time"), py::arg("ids"), py::arg("ctrlids"),
+             py::arg("tol") = 1.e-12, release_gil())
+        .def("apply_pauli_rotations", &Sim::apply_pauli_rotations,
+             py::arg("rotations"), py::arg("ids"), py::arg("ctrlids"),
+             py::arg("num_steps") = 1, release_gil())
+        .def("get_probability", &Sim::get_probability, release_gil())
+        .def("get_amplitude", &Sim::get_amplitude, release_gil())
+        .def("set_wavefunction", &set_wavefunction_wrapper<Sim>)
+        .def("collapse_wavefunction", &Sim::collapse_wavefunction, release_gil())
+        .def("run", &Sim::run, release_gil())
+        .def("cheat", &cheat_wrapper<Sim>)
+        .def("reserve_buffers", &Sim::reserve_buffers,
+             py::arg("num_qubits"), py::arg("count") = 2, release_gil())
+        .def("trim_buffers", &Sim::trim_buffers, py::arg("max_bytes") = 0,
+             release_gil())
+        .def("set_buffer_limit", &Sim::set_buffer_limit, release_gil())
+        .def("get_buffer_statistics", &buffer_statistics_wrapper<Sim>)
+        .def("set_kernels", &Sim::set_kernels)
+        .def("get_kernels", &Sim::get_kernels)
+        .def("benchmark_kernels", &Sim::benchmark_kernels, py::arg("num_qubits"),
+             py::arg("max_qubits") = 8, py::arg("repetitions") = 3, release_gil())
+        .def("set_fusion_costs", &Sim::set_fusion_costs, release_gil())
+        .def("get_fusion_costs", &Sim::get_fusion_costs)
+        .def("set_lookahead", &Sim::set_lookahead, release_gil())
+        .def("get_lookahead", &Sim::get_lookahead)
         ;
+}
+
+PYBIND11_PLUGIN(_cppsim) {
+    py::module m("_cppsim", "_cppsim");
+    bind_simulator<Simulator>(m, "Simulator");
+    bind_simulator<SimulatorT<float>>(m, "SimulatorFloat");
     return m.ptr();
 }
@@ -101,6 +101,29 @@ class Simulator(object):
         self._state *= 1. / _np.sqrt(nrm)
         return res
 
+    def sample(self, ids, shots):
+        """
+        Draw shots samples of the qubits with IDs ids without collapsing the
+        wavefunction.
+
+        Args:
+            ids (list<int>): List of qubit IDs to sample.
+            shots (int): Number of samples.
+
+        Returns:
+            Array of integers where bit i of each entry is the outcome of the
+            qubit ids[i].
+        """
+        cdf = _np.cumsum(_np.abs(self._state) ** 2)
+        rnd = _np.array([random.random() for _ in range(shots)]) * cdf[-1]
+        picked = _np.minimum(_np.searchsorted(cdf, rnd, side='right'),
+                             len(cdf) - 1)
+        res = _np.zeros(shots, dtype=_np.uint64)
+        for i, ID in enumerate(ids):
+            bits = ((picked >> self._map[ID]) & 1).astype(_np.uint64)
+            res |= bits << _np.uint64(i)
+        return res
+
     def allocate_qubit(self, ID):
         """
         Allocate a qubit.
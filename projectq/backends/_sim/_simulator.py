@@ -18,8 +18,12 @@ built first. If the c++ simulator is not exported to python, a (slow) python
 implementation is used as an alternative.
 """
 
+import json
 import math
+import multiprocessing
+import os
 import random
+import numpy
 from projectq.cengines import BasicEngine
 from projectq.meta import get_control_count, LogicalQubitIDTag
 from projectq.ops import (NOT,
@@ -36,10 +40,24 @@ from projectq.types import WeakQubitRef
 FALLBACK_TO_PYSIM = False
 try:
     from ._cppsim import Simulator as SimulatorBackend
+    from ._cppsim import SimulatorFloat as SimulatorFloatBackend
 except ImportError:
     from ._pysim import Simulator as SimulatorBackend
+    SimulatorFloatBackend = SimulatorBackend
     FALLBACK_TO_PYSIM = True
 
+# Opcodes of the command buffer (see Simulator::apply_commands in
+# _cppkernels/simulator.hpp)
+_OP_ALLOCATE = 0
+_OP_DEALLOCATE = 1
+_OP_GATE = 2
+_OP_MEASURE = 3
+_OP_RUN = 4
+
+# Generic math gates acting on at most this many qubits (in total) are
+# emulated using a table of the math function (see _emulate_math_table)
+_MAX_MATH_TABLE_QUBITS = 22
+
 
 class Simulator(BasicEngine):
     """
@@ -53,8 +71,22 @@ class Simulator(BasicEngine):
 
         export OMP_NUM_THREADS=4 # use 4 threads
         export OMP_PROC_BIND=spread # bind threads to processors by spreading
+
+    The C++ simulator releases the GIL while it is working on the state
+    vector. Hence, several Simulator instances (each with its own MainEngine)
+    can be run concurrently from different Python threads; a single instance
+    must not be used from several threads at the same time. When doing so,
+    consider reducing OMP_NUM_THREADS accordingly to avoid oversubscription.
+
+    Each instance of the C++ simulator recycles its large scratch buffers. By
+    default, it keeps at most one buffer of the size of the state vector (or
+    of the size reserved via reserve), i.e., its peak memory is about twice
+    the size of the state vector, and the buffers of a larger state are freed
+    once qubits are deallocated. More buffers can be kept by calling
+    reserve_buffers or set_buffer_limit of the underlying C++ object.
     """
-    def __init__(self, gate_fusion=False, rnd_seed=None):
+    def __init__(self, gate_fusion=False, rnd_seed=None, trotter_steps=None,
+                 precision='double', fusion_profile=None, lookahead=0):
         """
         Construct the C++/Python-simulator object and initialize it with a
         random seed.
@@ -65,13 +97,47 @@ class Simulator(BasicEngine):
                 for the c++ simulator).
             rnd_seed (int): Random seed (uses random.randint(0, 4294967295) by
                 default).
+            trotter_steps (int): If given, TimeEvolution gates are simulated
+                by this many first-order Trotter steps, each applying one
+                native Pauli rotation per term, which the c++ simulator
+                applies in a single call (only has an effect for the c++
+                simulator). By default, the time evolution is emulated
+                exactly.
+            precision (str): Floating-point precision of the state vector,
+                either 'double' (default) or 'single'. Single precision halves
+                the memory footprint and roughly doubles the speed of the
+                vectorized kernels at the cost of an accuracy of about 1e-7
+                (only has an effect for the c++ simulator; the gate matrices
+                are always fused in double precision).
+            fusion_profile (str): Path of a fusion profile written by
+                save_fusion_profile (only has an effect for the c++ simulator
+                if gate_fusion is True). If the file exists and was created
+                for the same kernels, precision and number of threads, its
+                cost model decides which gates are fused. Otherwise, the
+                default fusion of gates on up to 5 qubits is used. Profiles
+                are created explicitly by calling tune_fusion, which takes a
+                few seconds, and save_fusion_profile.
+            lookahead (int): If positive, windows of this many gates are
+                reordered before fusing them (only has an effect for the c++
+                simulator if gate_fusion is True): commuting gates are grouped
+                into clusters on few qubits, such that interleaved gates on
+                different qubits can still be fused. The gates are applied
+                lazily, i.e., once the window is full or the state is queried
+                (e.g. by a measurement or cheat()).
+
+        If the backend supports it (C++ simulator), allocations, gates,
+        deallocations and measurements are not forwarded one by one, but
+        collected in a command buffer which is executed with a single call
+        into the C++ code once a FlushGate, a measurement or a deallocation
+        is received (or the simulator is queried).
 
         Example of gate_fusion: Instead of applying a Hadamard gate to 5
         qubits, the simulator calculates the kronecker product of the 1-qubit
         gate matrices and then applies one 5-qubit gate. This increases
         operational intensity and keeps the simulator from having to iterate
         through the state vector multiple times. Depending on the system (and,
-        especially, number of threads), this may or may not be beneficial.
+        especially, number of threads), this may or may not be beneficial,
+        which is what the cost model of a fusion profile takes into account.
 
         Note:
             If the C++ Simulator extension was not built or cannot be found,
@@ -85,16 +151,112 @@ class Simulator(BasicEngine):
         """
         if rnd_seed is None:
             rnd_seed = random.randint(0, 4294967295)
+        if precision == 'double':
+            backend = SimulatorBackend
+        elif precision == 'single':
+            backend = SimulatorFloatBackend
+        else:
+            raise ValueError("Unknown precision '{}' (expected 'double' or "
+                             "'single').".format(precision))
         BasicEngine.__init__(self)
-        self._simulator = SimulatorBackend(rnd_seed)
+        self._simulator = backend(rnd_seed)
+        self._precision = precision
         self._gate_fusion = gate_fusion
+        self._trotter_steps = trotter_steps
+        self._math_tables = dict()
+        self._reset_command_buffer()
+        if lookahead > 0 and gate_fusion and not FALLBACK_TO_PYSIM:
+            self._simulator.set_lookahead(lookahead)
+        if (fusion_profile is not None and gate_fusion
+                and not FALLBACK_TO_PYSIM):
+            if os.path.exists(fusion_profile):
+                self.load_fusion_profile(fusion_profile)
+
+    def _fusion_host(self):
+        """
+        Return the properties of the machine and simulator a fusion profile
+        is only valid for.
+        """
+        return {'kernels': self._simulator.get_kernels(),
+                'precision': self._precision,
+                'cpu_count': multiprocessing.cpu_count(),
+                'omp_num_threads': os.environ.get('OMP_NUM_THREADS')}
+
+    def tune_fusion(self, num_qubits=20, max_qubits=6, repetitions=3):
+        """
+        Benchmark the gate kernels on this machine and use the resulting cost
+        model for gate fusion (C++ simulator only).
+
+        The time of applying a k-qubit gate is measured for k = 1, ...,
+        max_qubits on a state of num_qubits qubits (without touching the
+        simulated state). A gate is then added to the fused gates if applying
+        the grown fused matrix is expected to be faster than applying the
+        current one and the gate separately.
+
+        With the default arguments, the benchmark allocates a state of 2^20
+        amplitudes and takes a few seconds. Save the result with
+        save_fusion_profile and pass it as fusion_profile to later
+        simulators instead of tuning each of them.
+
+        Args:
+            num_qubits (int): Number of qubits of the benchmark state (should
+                exceed the caches, like the states to be simulated).
+            max_qubits (int): Maximum number of qubits of fused gates (<= 8).
+            repetitions (int): The best of this many runs is used.
+
+        Returns:
+            The profile (dict), see save_fusion_profile.
+        """
+        costs = self._simulator.benchmark_kernels(num_qubits, max_qubits,
+                                                  repetitions)
+        self._simulator.set_fusion_costs(costs)
+        profile = self._fusion_host()
+        profile['num_qubits'] = num_qubits
+        profile['costs'] = list(costs)
+        return profile
+
+    def save_fusion_profile(self, filename):
+        """
+        Save the cost model of gate fusion (see tune_fusion) to a JSON file,
+        together with the properties of the machine it was measured on.
+
+        Args:
+            filename (str): Path of the profile.
+        """
+        profile = self._fusion_host()
+        profile['costs'] = list(self._simulator.get_fusion_costs())
+        with open(filename, 'w') as f:
+            json.dump(profile, f, indent=1)
+
+    def load_fusion_profile(self, filename):
+        """
+        Load the cost model of gate fusion from a file written by
+        save_fusion_profile.
+
+        Args:
+            filename (str): Path of the profile.
+
+        Returns:
+            True if the profile was loaded and False if it was created for
+            other kernels, precision or number of threads (in which case the
+            current cost model is kept).
+        """
+        with open(filename) as f:
+            profile = json.load(f)
+        for key, value in self._fusion_host().items():
+            if profile.get(key) != value:
+                return False
+        self._simulator.set_fusion_costs(profile['costs'])
+        return True
 
     def is_available(self, cmd):
         """
         Specialized implementation of is_available: The simulator can deal
         with all arbitrarily-controlled gates which provide a
-        gate-matrix (via gate.matrix) and acts on 5 or less qubits (not
-        counting the control qubits).
+        gate-matrix (via gate.matrix) and acts on 8 or less qubits (not
+        counting the control qubits). Time evolution gates are always
+        available; they are either emulated exactly or, if trotter_steps was
+        given, simulated using native Pauli rotations.
 
         Args:
             cmd (Command): Command for which to check availability (single-
@@ -110,8 +272,8 @@ class Simulator(BasicEngine):
             return True
         try:
             m = cmd.gate.matrix
-            # Allow up to 5-qubit gates
-            if len(m) > 2 ** 5:
+            # Allow up to 8-qubit gates
+            if len(m) > 2 ** 8:
                 return False
             return True
         except:
@@ -173,6 +335,7 @@ class Simulator(BasicEngine):
                                 "contained in the qureg.")
         operator = [(list(term), coeff) for (term, coeff)
                     in qubit_operator.terms.items()]
+        self._run_command_buffer()
         return self._simulator.get_expectation_value(operator,
                                                      [qb.id for qb in qureg])
 
@@ -213,6 +376,7 @@ class Simulator(BasicEngine):
                                 "contained in the qureg.")
         operator = [(list(term), coeff) for (term, coeff)
                     in qubit_operator.terms.items()]
+        self._run_command_buffer()
         return self._simulator.apply_qubit_operator(operator,
                                                     [qb.id for qb in qureg])
 
@@ -240,9 +404,38 @@ class Simulator(BasicEngine):
         """
         qureg = self._convert_logical_to_mapped_qureg(qureg)
         bit_string = [bool(int(b)) for b in bit_string]
+        self._run_command_buffer()
         return self._simulator.get_probability(bit_string,
                                                [qb.id for qb in qureg])
 
+    def sample(self, qureg, shots=1):
+        """
+        Draw `shots` samples of the measurement outcome of the quantum
+        register `qureg` without collapsing the wavefunction.
+
+        Args:
+            qureg (Qureg|list[Qubit]): Quantum register to sample (at most 64
+                qubits).
+            shots (int): Number of samples to draw.
+
+        Returns:
+            Array of `shots` unsigned integers where bit i of each entry is the
+            outcome of qureg[i].
+
+        Note:
+            Make sure all previous commands (especially allocations) have
+            passed through the compilation chain (call main_engine.flush() to
+            make sure).
+
+        Note:
+            If there is a mapper present in the compiler, this function
+            automatically converts from logical qubits to mapped qubits for
+            the qureg argument.
+        """
+        qureg = self._convert_logical_to_mapped_qureg(qureg)
+        self._run_command_buffer()
+        return self._simulator.sample([qb.id for qb in qureg], shots)
+
     def get_amplitude(self, bit_string, qureg):
         """
         Return the probability amplitude of the supplied `bit_string`.
@@ -269,6 +462,7 @@ class Simulator(BasicEngine):
         """
         qureg = self._convert_logical_to_mapped_qureg(qureg)
         bit_string = [bool(int(b)) for b in bit_string]
+        self._run_command_buffer()
         return self._simulator.get_amplitude(bit_string,
                                              [qb.id for qb in qureg])
 
@@ -280,8 +474,10 @@ class Simulator(BasicEngine):
         the wavefunction).
 
         Args:
-            wavefunction (list[complex]): Array of complex amplitudes
-                describing the wavefunction (must be normalized).
+            wavefunction (list[complex]|numpy.ndarray): Array of complex
+                amplitudes describing the wavefunction (must be normalized).
+                A contiguous complex128 NumPy array is copied directly into
+                the C++ simulator without intermediate conversion.
             qureg (Qureg|list[Qubit]): Quantum register determining the
                 ordering. Must contain all allocated qubits.
 
@@ -296,6 +492,7 @@ class Simulator(BasicEngine):
             the qureg argument.
         """
         qureg = self._convert_logical_to_mapped_qureg(qureg)
+        self._run_command_buffer()
         self._simulator.set_wavefunction(wavefunction,
                                          [qb.id for qb in qureg])
 
@@ -322,6 +519,7 @@ class Simulator(BasicEngine):
             the qureg argument.
         """
         qureg = self._convert_logical_to_mapped_qureg(qureg)
+        self._run_command_buffer()
         return self._simulator.collapse_wavefunction([qb.id for qb in qureg],
                                                      [bool(int(v)) for v in
                                                       values])
@@ -342,13 +540,78 @@ class Simulator(BasicEngine):
             Make sure all previous commands have passed through the
             compilation chain (call main_engine.flush() to make sure).
 
+        Note:
+            For the C++ simulator, the state vector is returned as a read-only
+            NumPy array which shares the simulator's memory instead of copying
+            it. It is a snapshot: if it is still referenced when the next
+            command is executed, the simulator continues on a copy, i.e., the
+            array is never changed or invalidated. Use numpy.array(state) to
+            obtain a modifiable copy.
+
         Note:
             If there is a mapper present in the compiler, this function
             DOES NOT automatically convert from logical qubits to mapped
             qubits.
         """
+        self._run_command_buffer()
         return self._simulator.cheat()
 
+    def _reset_command_buffer(self):
+        """
+        Clear the buffer of commands which have not been sent to the
+        simulator backend yet.
+        """
+        self._cmd_program = []
+        self._cmd_matrices = []
+        self._cmd_matrix_size = 0
+        self._cmd_measured_qubits = []
+        self._cmd_last = None
+
+    def _buffer_command(self, opcode, ids, ctrlids=(), aux=0, merge=False):
+        """
+        Append a command to the command buffer.
+
+        Args:
+            opcode (int): One of the _OP_* opcodes.
+            ids (list[int]): Target qubit ids.
+            ctrlids (list[int]): Control qubit ids.
+            aux (int): Matrix offset (_OP_GATE) or first measurement slot
+                (_OP_MEASURE).
+            merge (bool): If True and the last buffered command has the same
+                opcode, the ids are appended to that command instead (used to
+                batch allocations, deallocations and measurements).
+        """
+        last = self._cmd_last
+        if (merge and last is not None and
+                self._cmd_program[last] == opcode and
+                self._cmd_program[last + 2] == 0):
+            self._cmd_program[last + 1] += len(ids)
+            self._cmd_program += ids
+            return
+        self._cmd_last = len(self._cmd_program)
+        self._cmd_program += [opcode, len(ids), len(ctrlids), aux]
+        self._cmd_program += ids
+        self._cmd_program += ctrlids
+
+    def _run_command_buffer(self):
+        """
+        Execute all buffered commands with a single call to the simulator
+        backend and report the measurement outcomes to the main engine.
+        """
+        if len(self._cmd_program) == 0:
+            return
+        program = self._cmd_program
+        if len(self._cmd_matrices) > 0:
+            matrices = numpy.concatenate(self._cmd_matrices)
+        else:
+            matrices = numpy.zeros(0, dtype=numpy.complex128)
+        measured_qubits = self._cmd_measured_qubits
+        self._reset_command_buffer()
+
+        out = self._simulator.apply_commands(program, matrices)
+        for i, qb in enumerate(measured_qubits):
+            self.main_engine.set_measurement_result(qb, out[i])
+
     def _handle(self, cmd):
         """
         Handle all commands, i.e., call the member functions of the C++-
@@ -362,11 +625,11 @@ class Simulator(BasicEngine):
             Exception: If a non-single-qubit gate needs to be processed
                 (which should never happen due to is_available).
         """
+        buffered = hasattr(self._simulator, 'apply_commands')
         if cmd.gate == Measure:
             assert(get_control_count(cmd) == 0)
             ids = [qb.id for qr in cmd.qubits for qb in qr]
-            out = self._simulator.measure_qubits(ids)
-            i = 0
+            qubits = []
             for qr in cmd.qubits:
                 for qb in qr:
                     # Check if a mapper assigned a different logical id
@@ -377,14 +640,31 @@ class Simulator(BasicEngine):
                     if logical_id_tag is not None:
                         qb = WeakQubitRef(qb.engine,
                                           logical_id_tag.logical_qubit_id)
-                    self.main_engine.set_measurement_result(qb, out[i])
-                    i += 1
+                    qubits.append(qb)
+            if buffered:
+                # consecutive measurements are executed at once (see receive)
+                self._buffer_command(_OP_MEASURE, ids,
+                                     aux=len(self._cmd_measured_qubits),
+                                     merge=True)
+                self._cmd_measured_qubits += qubits
+            else:
+                out = self._simulator.measure_qubits(ids)
+                for qb, value in zip(qubits, out):
+                    self.main_engine.set_measurement_result(qb, value)
         elif cmd.gate == Allocate:
             ID = cmd.qubits[0][0].id
-            self._simulator.allocate_qubit(ID)
+            if buffered:
+                # consecutive allocations are executed at once
+                self._buffer_command(_OP_ALLOCATE, [ID], merge=True)
+            else:
+                self._simulator.allocate_qubit(ID)
         elif cmd.gate == Deallocate:
             ID = cmd.qubits[0][0].id
-            self._simulator.deallocate_qubit(ID)
+            if buffered:
+                # consecutive deallocations are executed at once
+                self._buffer_command(_OP_DEALLOCATE, [ID], merge=True)
+            else:
+                self._simulator.deallocate_qubit(ID)
         elif isinstance(cmd.gate, BasicMathGate):
             # improve performance by using C++ code for some commomn gates
             from projectq.libs.math import (AddConstant,
@@ -395,6 +675,7 @@ class Simulator(BasicEngine):
                 qubitids.append([])
                 for qb in qr:
                     qubitids[-1].append(qb.id)
+            self._run_command_buffer()
             if FALLBACK_TO_PYSIM:
                 math_fun = cmd.gate.get_math_function(cmd.qubits)
                 self._simulator.emulate_math(math_fun, qubitids,
@@ -410,6 +691,11 @@ class Simulator(BasicEngine):
                 elif isinstance(cmd.gate, MultiplyByConstantModN):
                     self._simulator.emulate_math_multiplyByConstantModN(cmd.gate.a, cmd.gate.N, qubitids,
                                                                         [qb.id for qb in cmd.control_qubits])
+                elif (hasattr(self._simulator, 'emulate_math_table') and
+                      sum(len(qr) for qr in qubitids) <=
+                      _MAX_MATH_TABLE_QUBITS):
+                    self._emulate_math_table(cmd, qubitids,
+                                             [qb.id for qb in cmd.control_qubits])
                 else:
                     math_fun = cmd.gate.get_math_function(cmd.qubits)
                     self._simulator.emulate_math(math_fun, qubitids,
@@ -420,8 +706,17 @@ class Simulator(BasicEngine):
             t = cmd.gate.time
             qubitids = [qb.id for qb in cmd.qubits[0]]
             ctrlids = [qb.id for qb in cmd.control_qubits]
-            self._simulator.emulate_time_evolution(op, t, qubitids, ctrlids)
-        elif len(cmd.gate.matrix) <= 2 ** 5:
+            self._run_command_buffer()
+            if (self._trotter_steps is not None and
+                    hasattr(self._simulator, 'apply_pauli_rotations')):
+                step = [(term, coeff * t / self._trotter_steps)
+                        for (term, coeff) in op]
+                self._simulator.apply_pauli_rotations(step, qubitids, ctrlids,
+                                                      self._trotter_steps)
+            else:
+                self._simulator.emulate_time_evolution(op, t, qubitids,
+                                                       ctrlids)
+        elif len(cmd.gate.matrix) <= 2 ** 8:
             matrix = cmd.gate.matrix
             ids = [qb.id for qr in cmd.qubits for qb in qr]
             if not 2 ** len(ids) == len(cmd.gate.matrix):
@@ -430,17 +725,100 @@ class Simulator(BasicEngine):
                                     str(cmd.gate),
                                     int(math.log(len(cmd.gate.matrix), 2)),
                                     len(ids)))
-            self._simulator.apply_controlled_gate(matrix.tolist(),
-                                                  ids,
-                                                  [qb.id for qb in
-                                                   cmd.control_qubits])
-            if not self._gate_fusion:
-                self._simulator.run()
+            ctrlids = [qb.id for qb in cmd.control_qubits]
+            if buffered:
+                matrix = numpy.asarray(matrix, dtype=numpy.complex128)
+                self._buffer_command(_OP_GATE, ids, ctrlids,
+                                     aux=self._cmd_matrix_size)
+                self._cmd_matrices.append(matrix.ravel())
+                self._cmd_matrix_size += matrix.size
+                if not self._gate_fusion:
+                    self._buffer_command(_OP_RUN, [])
+            else:
+                self._simulator.apply_controlled_gate(matrix.tolist(),
+                                                      ids, ctrlids)
+                if not self._gate_fusion:
+                    self._simulator.run()
         else:
             raise Exception("This simulator only supports controlled k-qubit"
-                            " gates with k < 6!\nPlease add an auto-replacer"
+                            " gates with k < 9!\nPlease add an auto-replacer"
                             " engine to your list of compiler engines.")
 
+    def _emulate_math_table(self, cmd, qubitids, ctrlids):
+        """
+        Emulate a math gate by evaluating its math function once for all
+        possible register values and letting the C++ simulator apply the
+        resulting table. Tables are cached per gate and register sizes.
+        """
+        sizes = tuple(len(qr) for qr in qubitids)
+        key = (id(cmd.gate), sizes)
+        entry = self._math_tables.get(key)
+        if entry is None or entry[0] is not cmd.gate:
+            table = self._get_math_table(
+                cmd.gate.get_math_function(cmd.qubits), sizes)
+            if len(self._math_tables) >= 16:
+                self._math_tables.clear()
+            entry = (cmd.gate, table)
+            self._math_tables[key] = entry
+        self._simulator.emulate_math_table(entry[1], qubitids, ctrlids)
+
+    @staticmethod
+    def _get_math_table(math_fun, sizes):
+        """
+        Return the values of the math function for all register values as a
+        table indexed by the concatenated register values (first register in
+        the lowest bits).
+
+        The math function is called once with NumPy arrays holding all input
+        values of each register. The result is only used if it consists of
+        integers within the range of each register (e.g., not wrapped around
+        by an overflow of int64) and agrees with scalar calls on a sample of
+        the inputs. Otherwise, or if the function fails on arrays (e.g., since
+        it calls methods of int), it is called once per tuple of register
+        values.
+        """
+        index = numpy.arange(2 ** sum(sizes), dtype=numpy.int64)
+        inputs = []
+        offset = 0
+        for size in sizes:
+            inputs.append((index >> offset) & (2 ** size - 1))
+            offset += size
+        try:
+            outputs = [numpy.asarray(out) for out in math_fun(list(inputs))]
+            if len(outputs) != len(sizes):
+                raise ValueError("Math function returned the wrong number of "
+                                 "registers.")
+            for k, size in enumerate(sizes):
+                if outputs[k].dtype.kind not in 'iu':
+                    raise TypeError("Math function returned non-integers.")
+                outputs[k] = numpy.broadcast_to(
+                    outputs[k].astype(numpy.int64), index.shape)
+                if (outputs[k].size > 0 and
+                        (outputs[k].min() < 0 or
+                         outputs[k].max() >= 2 ** size)):
+                    raise ValueError("Math function result out of range.")
+            # spot-check against scalar evaluation
+            samples = numpy.unique(numpy.linspace(0, len(index) - 1, 17,
+                                                  dtype=numpy.int64))
+            for i in samples:
+                res = math_fun([int(x[i]) for x in inputs])
+                if any(int(res[k]) != int(outputs[k][i])
+                       for k in range(len(sizes))):
+                    raise ValueError("Vectorized math function differs.")
+        except Exception:
+            # scalar evaluation re-raises errors of the function itself
+            results = [math_fun([int(x[i]) for x in inputs])
+                       for i in range(len(index))]
+            outputs = [numpy.array([int(res[k]) for res in results],
+                                   dtype=numpy.int64)
+                       for k in range(len(sizes))]
+        table = numpy.zeros(len(index), dtype=numpy.uint64)
+        offset = 0
+        for size, out in zip(sizes, outputs):
+            table |= ((out & (2 ** size - 1)) << offset).astype(numpy.uint64)
+            offset += size
+        return table
+
     def receive(self, command_list):
         """
         Receive a list of commands from the previous engine and handle them
@@ -451,10 +829,29 @@ class Simulator(BasicEngine):
             command_list (list<Command>): List of commands to execute on the
                 simulator.
         """
-        for cmd in command_list:
+        for i, cmd in enumerate(command_list):
             if not cmd.gate == FlushGate():
                 self._handle(cmd)
+                # measurements and deallocations are executed right away such
+                # that the outcomes are available and errors are raised by the
+                # corresponding command. Consecutive ones are executed
+                # together, which allows to measure and release qubits in one
+                # go (only if there are no further engines which might want
+                # to see the measurement outcomes first).
+                next_gate = None
+                if i + 1 < len(command_list):
+                    next_gate = command_list[i + 1].gate
+                if cmd.gate == Deallocate:
+                    if next_gate is None or not next_gate == Deallocate:
+                        self._run_command_buffer()
+                elif cmd.gate == Measure:
+                    if (not self.is_last_engine or next_gate is None or
+                            not (next_gate == Measure or
+                                 next_gate == Deallocate)):
+                        self._run_command_buffer()
             else:
-                self._simulator.run()  # flush gate --> run all saved gates
+                # flush gate --> run all buffered and saved gates
+                self._run_command_buffer()
+                self._simulator.run()
             if not self.is_last_engine:
                 self.send([cmd])
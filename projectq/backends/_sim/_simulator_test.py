@@ -31,7 +31,8 @@ from projectq.cengines import (BasicEngine, BasicMapperEngine, DummyEngine,
                                LocalOptimizer, NotYetMeasuredError)
 from projectq.ops import (All, Allocate, BasicGate, BasicMathGate, CNOT,
                           Command, H, MatrixGate, Measure, QubitOperator,
-                          Rx, Ry, Rz, S, TimeEvolution, Toffoli, X, Y, Z)
+                          Rx, Ry, Rz, S, Sdag, Swap, TimeEvolution, Toffoli,
+                          X, Y, Z)
 from projectq.meta import Control, Dagger, LogicalQubitIDTag
 from projectq.types import WeakQubitRef
 
@@ -121,6 +122,18 @@ class Mock6QubitGate(MatrixGate):
         return numpy.eye(2 ** 6)
 
 
+class MockKQubitGate(MatrixGate):
+    def __init__(self, num_qubits):
+        MatrixGate.__init__(self)
+        self.num_qubits = num_qubits
+        self.cnt = 0
+
+    @property
+    def matrix(self):
+        self.cnt += 1
+        return numpy.eye(2 ** self.num_qubits)
+
+
 class MockNoMatrixGate(BasicGate):
     def __init__(self):
         BasicGate.__init__(self)
@@ -147,7 +160,7 @@ def test_simulator_is_available(sim):
     assert new_cmd.gate.cnt == 1
 
     new_cmd.gate = Mock6QubitGate()
-    assert not sim.is_available(new_cmd)
+    assert sim.is_available(new_cmd)
     assert new_cmd.gate.cnt == 1
 
     new_cmd.gate = MockNoMatrixGate()
@@ -155,6 +168,22 @@ def test_simulator_is_available(sim):
     assert new_cmd.gate.cnt == 0
 
 
+def test_simulator_is_available_up_to_8_qubits(sim):
+    backend = DummyEngine(save_commands=True)
+    eng = MainEngine(backend, [])
+    qubit = eng.allocate_qubit()
+    new_cmd = backend.received_commands[-1]
+
+    new_cmd.gate = MockKQubitGate(8)
+    assert sim.is_available(new_cmd)
+    assert new_cmd.gate.cnt == 1
+
+    new_cmd.gate = MockKQubitGate(9)
+    assert not sim.is_available(new_cmd)
+    assert new_cmd.gate.cnt == 1
+    del qubit
+
+
 def test_simulator_cheat(sim):
     # cheat function should return a tuple
     assert isinstance(sim.cheat(), tuple)
@@ -180,6 +209,33 @@ def test_simulator_cheat(sim):
     assert len(sim.cheat()[1]) == 1
 
 
+def test_simulator_cheat_state_view(sim):
+    eng = MainEngine(sim, [])
+    qureg = eng.allocate_qureg(2)
+    eng.flush()
+    wf = numpy.array([0., 0., 1j, 0.])
+    sim.set_wavefunction(wf, qureg)
+    state = sim.cheat()[1]
+    assert numpy.allclose(state, wf)
+    from projectq.backends._sim._pysim import Simulator as PySim
+    if not isinstance(sim._simulator, PySim):
+        # the state vector is a read-only view of the simulator's memory
+        assert numpy.shares_memory(state, sim.cheat()[1])
+        with pytest.raises(ValueError):
+            state[0] = 1.
+        # which keeps its values while the simulator continues on a copy
+        X | qureg[0]
+        eng.flush()
+        assert numpy.allclose(state, wf)
+        assert numpy.allclose(sim.cheat()[1], [0., 0., 0., 1j])
+    # a copy can be modified and used to set the wavefunction
+    state = numpy.array(state)
+    state[:] = [0., 0., 0., 1.]
+    sim.set_wavefunction(state, qureg)
+    assert sim.get_probability('11', qureg) == pytest.approx(1.)
+    All(Measure) | qureg
+
+
 def test_simulator_functional_measurement(sim):
     eng = MainEngine(sim, [])
     qubits = eng.allocate_qureg(5)
@@ -237,6 +293,101 @@ def test_simulator_emulation(sim):
     All(Measure) | (qubit1 + qubit2 + qubit3)
 
 
+def test_simulator_emulation_math_table(sim):
+    eng = MainEngine(sim, [])
+    a = eng.allocate_qureg(3)
+    b = eng.allocate_qureg(2)
+    X | a[0]
+    X | a[2]
+    X | b[1]
+    # vectorizable function of two registers
+    add_gate = BasicMathGate(lambda x, y: (x, (x + y) % 4))
+    add_gate | (a, b)
+    eng.flush()
+    assert sim.get_probability('10111', a + b) == pytest.approx(1.)
+    # cached table
+    add_gate | (a, b)
+    eng.flush()
+    assert sim.get_probability('10100', a + b) == pytest.approx(1.)
+    # function which cannot be evaluated on arrays
+    BasicMathGate(lambda x: (x - 1 if x > 0 else 7,)) | a
+    eng.flush()
+    assert sim.get_probability('001', a) == pytest.approx(1.)
+    All(Measure) | a + b
+
+
+def test_simulator_get_math_table():
+    calls = []
+
+    def get_table(fun, sizes):
+        del calls[:]
+
+        def math_fun(x):
+            calls.append(x)
+            return fun(*x)
+        return list(Simulator._get_math_table(math_fun, sizes))
+
+    # vectorized: one call with arrays, checked against scalar calls
+    table = get_table(lambda x, y: (x, (x + y) % 4), (3, 2))
+    assert table == [x | (((x + y) % 4) << 3)
+                     for y in range(4) for x in range(8)]
+    assert len(calls) < 32
+    # results out of range of the register and non-integer results are
+    # evaluated per value
+    table = get_table(lambda x: (x + 5,), (3,))
+    assert table == [(x + 5) % 8 for x in range(8)]
+    assert len(calls) == 1 + 8
+    table = get_table(lambda x: (x / 2,), (3,))
+    assert table == [x // 2 for x in range(8)]
+    assert len(calls) == 1 + 8
+    # functions which only work on scalars are evaluated per value
+    table = get_table(lambda x: (x.bit_length(),), (3,))
+    assert table == [x.bit_length() for x in range(8)]
+    assert len(calls) == 1 + 8
+
+
+def test_simulator_emulate_math_parallel_scatter():
+    if "cpp_simulator" not in get_available_simulators():
+        pytest.skip("No C++ simulator")
+    # the constant math fallbacks and non-bijective tables scatter the
+    # amplitudes in parallel; compare with the serial emulate_math
+    n = 16
+    rng = numpy.random.RandomState(7)
+    wf = rng.randn(2 ** n) + 1j * rng.randn(2 ** n)
+    wf /= numpy.linalg.norm(wf)
+
+    def run(apply):
+        sim = Simulator()
+        eng = MainEngine(sim, [])
+        qureg = eng.allocate_qureg(n)
+        eng.flush()
+        sim.set_wavefunction(wf, qureg)
+        ids = [qb.id for qb in qureg]
+        apply(sim._simulator, [ids[:7], ids[7:15]], [ids[15]])
+        state = numpy.array(sim.cheat()[1])
+        All(Measure) | qureg
+        return state
+
+    def add(x):
+        return [v + 5 for v in x]
+
+    def squash(x):
+        return [x[0], (x[1] ^ x[0]) & 0xFE]
+
+    table = numpy.array([x | (squash([x & 127, x >> 7])[1] << 7)
+                         for x in range(2 ** 15)], dtype=numpy.uint64)
+    # bijective function of several registers
+    parallel = run(lambda s, regs, c: s.emulate_math_addConstant(5, regs, c))
+    serial = run(lambda s, regs, c: s.emulate_math(add, regs, c))
+    assert not numpy.allclose(serial, wf)
+    assert numpy.allclose(parallel, serial)
+    # non-bijective function: amplitudes are summed up
+    parallel = run(lambda s, regs, c: s.emulate_math_table(table, regs, c))
+    serial = run(lambda s, regs, c: s.emulate_math(squash, regs, c))
+    assert numpy.count_nonzero(serial) == 2 ** n - 2 ** 14
+    assert numpy.allclose(parallel, serial)
+
+
 def test_simulator_kqubit_gate(sim):
     m1 = Rx(0.3).matrix
     m2 = Rx(0.8).matrix
@@ -269,12 +420,148 @@ def test_simulator_kqubit_gate(sim):
     class LargerGate(BasicGate):
         @property
         def matrix(self):
-            return numpy.eye(2 ** 6)
+            return numpy.eye(2 ** 9)
 
     with pytest.raises(Exception):
         LargerGate() | (qureg + qubit)
 
 
+@pytest.mark.parametrize("num_qubits", [6, 8])
+def test_simulator_large_kqubit_gate(sim, num_qubits):
+    angles = numpy.linspace(0.1, 1.5, num_qubits)
+    m = numpy.ones((1, 1))
+    for angle in angles:
+        m = numpy.kron(Ry(angle).matrix, m)
+
+    class KQubitGate(BasicGate):
+        @property
+        def matrix(self):
+            return m
+
+    eng = MainEngine(sim, [])
+    qureg = eng.allocate_qureg(num_qubits)
+    qubit = eng.allocate_qubit()
+    with Control(eng, qubit):
+        KQubitGate() | qureg
+    eng.flush()
+    assert sim.get_amplitude('0' * (num_qubits + 1),
+                             qureg + qubit) == pytest.approx(1.)
+    X | qubit
+    with Control(eng, qubit):
+        KQubitGate() | qureg
+    for qb, angle in zip(qureg, angles):
+        Ry(-angle) | qb
+    eng.flush()
+    assert sim.get_amplitude('0' * num_qubits + '1',
+                             qureg + qubit) == pytest.approx(1.)
+    All(Measure) | qureg + qubit
+
+
+def test_simulator_diagonal_gates(sim):
+    eng = MainEngine(sim, [])
+    qureg = eng.allocate_qureg(4)
+    All(H) | qureg
+
+    def diagonal_gates():
+        Rz(0.3) | qureg[0]
+        S | qureg[1]
+        with Control(eng, qureg[2]):
+            Rz(0.7) | qureg[3]
+            Z | qureg[0]
+
+    def circuit():
+        diagonal_gates()
+        # does not commute with the diagonal gates on qureg[1]
+        H | qureg[1]
+        with Control(eng, qureg[0:2]):
+            Rz(-1.1) | qureg[3]
+        Z | qureg[2]
+        Rx(0.4) | qureg[0]
+
+    diagonal_gates()
+    eng.flush()
+    assert sim.get_amplitude('0000', qureg) == pytest.approx(
+        numpy.exp(-0.15j) / 4.)
+    assert sim.get_amplitude('1111', qureg) == pytest.approx(
+        -1j * numpy.exp(0.5j) / 4.)
+    with Dagger(eng):
+        diagonal_gates()
+    circuit()
+    with Dagger(eng):
+        circuit()
+    All(H) | qureg
+    eng.flush()
+    assert sim.get_amplitude('0000', qureg) == pytest.approx(1.)
+    All(Measure) | qureg
+
+
+def test_simulator_many_controlled_diagonal_gates(sim):
+    eng = MainEngine(sim, [])
+    qureg = eng.allocate_qureg(10)
+    All(H) | qureg
+    # diagonal gates with many controls are applied by the controlled
+    # kernels, the others are collected as diagonal gates
+    with Control(eng, qureg[1:]):
+        Z | qureg[0]
+    with Control(eng, qureg[0]):
+        S | qureg[1]
+    with Control(eng, qureg[:9]):
+        Rz(0.6) | qureg[9]
+    eng.flush()
+    assert sim.get_amplitude('1111111111', qureg) == pytest.approx(
+        -1j * numpy.exp(0.3j) / 32.)
+    assert sim.get_amplitude('1111111110', qureg) == pytest.approx(
+        1j * numpy.exp(-0.3j) / 32.)
+    assert sim.get_amplitude('0111111111', qureg) == pytest.approx(1. / 32.)
+    assert sim.get_amplitude('1100000000', qureg) == pytest.approx(1j / 32.)
+    with Control(eng, qureg[:9]):
+        Rz(-0.6) | qureg[9]
+    with Control(eng, qureg[0]):
+        Sdag | qureg[1]
+    with Control(eng, qureg[1:]):
+        Z | qureg[0]
+    All(H) | qureg
+    eng.flush()
+    assert sim.get_amplitude('0000000000', qureg) == pytest.approx(1.)
+    All(Measure) | qureg
+
+
+def test_simulator_permutation_gates(sim):
+    eng = MainEngine(sim, [])
+    qureg = eng.allocate_qureg(3)
+    X | qureg[0]
+    X | qureg[1]
+    Toffoli | (qureg[0], qureg[1], qureg[2])
+    Y | qureg[1]
+    Swap | (qureg[0], qureg[1])
+    eng.flush()
+    assert sim.get_amplitude('011', qureg) == pytest.approx(-1j)
+    H | qureg[0]
+    CNOT | (qureg[0], qureg[2])
+    eng.flush()
+    assert sim.get_amplitude('011', qureg) == pytest.approx(-1j / math.sqrt(2))
+    assert sim.get_amplitude('110', qureg) == pytest.approx(-1j / math.sqrt(2))
+    All(Measure) | qureg
+
+
+def test_simulator_multi_controlled_gates(sim):
+    eng = MainEngine(sim, [])
+    qureg = eng.allocate_qureg(5)
+    All(H) | qureg[0:3]
+    with Control(eng, qureg[0:3]):
+        X | qureg[3]
+        Rx(0.4) | qureg[4]
+    eng.flush()
+    norm = 1. / math.sqrt(8)
+    assert sim.get_amplitude('11000', qureg) == pytest.approx(norm)
+    assert sim.get_amplitude('11010', qureg) == pytest.approx(0.)
+    assert sim.get_amplitude('11110', qureg) == pytest.approx(
+        norm * math.cos(0.2))
+    assert sim.get_amplitude('11111', qureg) == pytest.approx(
+        -1j * norm * math.sin(0.2))
+    All(Measure) | qureg
+
+
 def test_simulator_kqubit_exception(sim):
     m1 = Rx(0.3).matrix
     m2 = Rx(0.8).matrix
@@ -424,6 +711,28 @@ def test_simulator_expectation_exception(sim):
         sim.get_expectation_value(op3, qureg)
 
 
+def test_simulator_expectation_grouped_terms(sim):
+    eng = MainEngine(sim, [])
+    qureg = eng.allocate_qureg(3)
+    Ry(.7) | qureg[0]
+    H | qureg[1]
+    S | qureg[1]
+    CNOT | (qureg[1], qureg[2])
+    Rx(.4) | qureg[2]
+    # several terms share the same flip mask (X0 Y1 / Y0 X1 / X0 X1 Z2 ...)
+    op = (QubitOperator('', .3) + QubitOperator('Z0', -1.2) +
+          QubitOperator('Z1 Z2', .5) + QubitOperator('X0 Y1', .7) +
+          QubitOperator('Y0 X1', -.4) + QubitOperator('X0 X1 Z2', .9) +
+          QubitOperator('Y2', .2) + QubitOperator('X1 Y2', -.6))
+    expectation = sim.get_expectation_value(op, qureg)
+    eng.flush()
+    state = numpy.array(sim.cheat()[1])
+    sim.apply_qubit_operator(op, qureg)
+    reference = numpy.vdot(state, sim.cheat()[1])
+    assert expectation == pytest.approx(reference.real)
+    assert abs(reference.imag) < 1e-12
+
+
 def test_simulator_applyqubitoperator_exception(sim):
     eng = MainEngine(sim, [])
     qureg = eng.allocate_qureg(3)
@@ -464,7 +773,8 @@ def test_simulator_applyqubitoperator(sim, mapper):
     assert sim.get_amplitude('000', qureg) == pytest.approx(0.)
 
 
-def test_simulator_time_evolution(sim):
+@pytest.mark.parametrize("diagonal", [False, True])
+def test_simulator_time_evolution(sim, diagonal):
     N = 8  # number of qubits
     time_to_evolve = 1.1  # time to evolve for
     eng = MainEngine(sim, [])
@@ -477,10 +787,17 @@ def test_simulator_time_evolution(sim):
     # Use cheat to get initial start wavefunction:
     qubit_to_bit_map, init_wavefunction = copy.deepcopy(eng.backend.cheat())
     Qop = QubitOperator
-    op = 0.3 * Qop("X0 Y1 Z2 Y3 X4")
-    op += 1.1 * Qop(())
-    op += -1.4 * Qop("Y0 Z1 X3 Y5")
-    op += -1.1 * Qop("Y1 X2 X3 Y4")
+    if diagonal:
+        # Ising-type Hamiltonian (evolution is a pure phase)
+        op = 0.3 * Qop("Z0 Z1 Z2 Z3 Z4")
+        op += 1.1 * Qop(())
+        op += -1.4 * Qop("Z0 Z5")
+        op += -1.1 * Qop("Z4")
+    else:
+        op = 0.3 * Qop("X0 Y1 Z2 Y3 X4")
+        op += 1.1 * Qop(())
+        op += -1.4 * Qop("Y0 Z1 X3 Y5")
+        op += -1.1 * Qop("Y1 X2 X3 Y4")
     ctrl_qubit = eng.allocate_qubit()
     H | ctrl_qubit
     with Control(eng, ctrl_qubit):
@@ -523,6 +840,32 @@ def test_simulator_time_evolution(sim):
                           init_wavefunction)
 
 
+def test_simulator_time_evolution_trotter(sim):
+    if "cpp_simulator" not in get_available_simulators():
+        pytest.skip("No C++ simulator")
+    trotter_sim = Simulator(trotter_steps=3, rnd_seed=1)
+    Qop = QubitOperator
+    # pairwise commuting terms, i.e., the Trotter decomposition is exact
+    op = (0.4 * Qop("X0 X1") + -1.3 * Qop("Y0 Y1") + 0.7 * Qop("Z0 Z1") +
+          0.2 * Qop("Z2") + 0.5 * Qop(()))
+    wavefunctions = []
+    for backend in (sim, trotter_sim):
+        eng = MainEngine(backend, [])
+        qureg = eng.allocate_qureg(3)
+        ctrl_qubit = eng.allocate_qubit()
+        Rx(.3) | qureg[0]
+        Ry(1.1) | qureg[1]
+        H | qureg[2]
+        H | ctrl_qubit
+        with Control(eng, ctrl_qubit):
+            TimeEvolution(1.7, op) | qureg
+        TimeEvolution(.4, Qop("X0 Y1 Z2")) | qureg
+        eng.flush()
+        wavefunctions.append(numpy.array(backend.cheat()[1]))
+        All(Measure) | qureg + ctrl_qubit
+    assert numpy.allclose(wavefunctions[0], wavefunctions[1])
+
+
 def test_simulator_set_wavefunction(sim, mapper):
     engine_list = [LocalOptimizer()]
     if mapper is not None:
@@ -592,6 +935,333 @@ def test_simulator_no_uncompute_exception(sim):
     assert qubit[0].id == -1
 
 
+def test_simulator_buffer_pool(sim):
+    eng = MainEngine(sim, [])
+    qureg = eng.allocate_qureg(4)
+    eng.flush()
+    backend = sim._simulator
+    stats = backend.get_buffer_statistics()
+    assert stats["misses"] > 0
+    assert stats["bytes_held"] <= stats["peak_bytes_held"]
+    backend.trim_buffers()
+    assert backend.get_buffer_statistics()["bytes_held"] == 0
+    backend.reserve_buffers(4, 2)
+    assert backend.get_buffer_statistics()["bytes_held"] == 2 * 16 * 16
+    misses = backend.get_buffer_statistics()["misses"]
+    # scratch buffers of the right size are recycled
+    sim.apply_qubit_operator(QubitOperator('X0'), qureg)
+    assert backend.get_buffer_statistics()["misses"] == misses
+    backend.set_buffer_limit(0)
+    assert backend.get_buffer_statistics()["bytes_held"] == 0
+    # buffers are per simulator instance
+    other = Simulator(gate_fusion=True)
+    assert other._simulator.get_buffer_statistics()["bytes_held"] == 0
+    All(Measure) | qureg
+
+
+def test_simulator_buffer_pool_limit(sim):
+    backend = sim._simulator
+    backend.allocate_qubits(list(range(10)))
+    # uses two scratch buffers, of which at most one is cached
+    backend.apply_qubit_operator([([(0, 'X')], 1.)], list(range(10)))
+    backend.apply_qubit_operator([([(0, 'X')], 1.)], list(range(10)))
+    stats = backend.get_buffer_statistics()
+    assert stats["peak_bytes_held"] == 16 * 2 ** 10
+    # buffers of the larger state are freed on deallocation
+    backend.deallocate_qubits(list(range(2, 10)))
+    assert backend.get_buffer_statistics()["bytes_held"] <= 16 * 2 ** 2
+
+
+def test_simulator_fusion_with_changing_controls():
+    # gates with different controls are fused into one matrix (controls which
+    # are not shared by all gates are absorbed into the fused matrix)
+    wavefunctions = []
+    for gate_fusion in (False, True):
+        sim = Simulator(gate_fusion=gate_fusion, rnd_seed=1)
+        eng = MainEngine(sim, [])
+        qureg = eng.allocate_qureg(6)
+        All(H) | qureg
+        with Control(eng, qureg[4]):
+            Rx(0.3) | qureg[0]
+            with Control(eng, qureg[5]):
+                Ry(0.4) | qureg[1]
+        Rx(0.5) | qureg[2]
+        with Control(eng, qureg[5]):
+            Swap | (qureg[1], qureg[3])
+        Ry(0.6) | qureg[0]
+        eng.flush()
+        wavefunctions.append(numpy.array(sim.cheat()[1]))
+        All(Measure) | qureg
+    assert numpy.allclose(wavefunctions[0], wavefunctions[1])
+
+
+def test_simulator_kernel_selection():
+    if "cpp_simulator" not in get_available_simulators():
+        pytest.skip("No C++ simulator")
+    m = numpy.kron(Rx(0.2).matrix, numpy.kron(Ry(0.5).matrix, Rz(0.7).matrix))
+
+    class KQubitGate(BasicGate):
+        @property
+        def matrix(self):
+            return m
+
+    wavefunctions = []
+    for isa in ("scalar", "avx2", "avx512"):
+        backend = Simulator(gate_fusion=True, rnd_seed=1)
+        try:
+            backend._simulator.set_kernels(isa)
+        except RuntimeError:
+            # not supported by this CPU
+            assert isa != "scalar"
+            continue
+        assert backend._simulator.get_kernels() == isa
+        eng = MainEngine(backend, [])
+        qureg = eng.allocate_qureg(5)
+        All(H) | qureg
+        Ry(0.3) | qureg[4]
+        KQubitGate() | qureg[1:4]
+        with Control(eng, qureg[0]):
+            KQubitGate() | qureg[2:5]
+        eng.flush()
+        wavefunctions.append(numpy.array(backend.cheat()[1]))
+        All(Measure) | qureg
+    for wavefunction in wavefunctions[1:]:
+        assert numpy.allclose(wavefunction, wavefunctions[0])
+    with pytest.raises(ValueError):
+        Simulator()._simulator.set_kernels("sse")
+
+
+def test_simulator_single_precision():
+    if "cpp_simulator" not in get_available_simulators():
+        pytest.skip("No C++ simulator")
+    from projectq.backends._sim._cppsim import SimulatorFloat
+    wavefunctions = []
+    for precision in ("double", "single"):
+        sim = Simulator(gate_fusion=True, rnd_seed=1, precision=precision)
+        eng = MainEngine(sim, [])
+        qureg = eng.allocate_qureg(6)
+        All(H) | qureg
+        Rx(0.3) | qureg[1]
+        with Control(eng, qureg[0]):
+            Ry(0.7) | qureg[5]
+        CNOT | (qureg[2], qureg[4])
+        Rz(0.2) | qureg[3]
+        eng.flush()
+        wavefunctions.append(numpy.array(sim.cheat()[1]))
+        assert sim.get_probability([0], [qureg[3]]) == pytest.approx(0.5)
+        All(Measure) | qureg
+    assert isinstance(sim._simulator, SimulatorFloat)
+    assert wavefunctions[1].dtype == numpy.complex64
+    assert numpy.allclose(wavefunctions[0], wavefunctions[1], atol=1e-6)
+    with pytest.raises(ValueError):
+        Simulator(precision="half")
+
+
+def test_simulator_time_evolution_single_precision():
+    if "cpp_simulator" not in get_available_simulators():
+        pytest.skip("No C++ simulator")
+    Qop = QubitOperator
+    # non-diagonal terms, i.e., the Chebyshev expansion is used
+    op = (0.8 * Qop("X0 Z1") + -0.4 * Qop("Y2") + 1.1 * Qop("X3 X4 Z5") +
+          0.3 * Qop("Z0"))
+    for time in (0.5, -3., 1.e-3):
+        wavefunctions = []
+        for precision in ("double", "single"):
+            sim = Simulator(precision=precision)
+            eng = MainEngine(sim, [])
+            qureg = eng.allocate_qureg(6)
+            All(H) | qureg
+            TimeEvolution(time, op) | qureg
+            eng.flush()
+            wavefunctions.append(numpy.array(sim.cheat()[1]))
+            All(Measure) | qureg
+        assert numpy.all(numpy.isfinite(wavefunctions[1]))
+        assert numpy.allclose(wavefunctions[0], wavefunctions[1], atol=1e-6)
+
+
+def test_simulator_fusion_profile(tmpdir, monkeypatch):
+    if "cpp_simulator" not in get_available_simulators():
+        pytest.skip("No C++ simulator")
+    profile = str(tmpdir.join("fusion.json"))
+    sim = Simulator(gate_fusion=True)
+    sim.tune_fusion(num_qubits=12, max_qubits=4, repetitions=1)
+    costs = sim._simulator.get_fusion_costs()
+    assert len(costs) == 4 and all(cost > 0 for cost in costs)
+    sim.save_fusion_profile(profile)
+
+    # the constructor loads the saved profile, but never tunes by itself
+    def no_tuning(self, *args, **kwargs):
+        raise AssertionError("Simulator() tuned the gate fusion.")
+
+    monkeypatch.setattr(Simulator, "tune_fusion", no_tuning)
+    tuned = Simulator(gate_fusion=True, fusion_profile=profile)
+    assert tuned._simulator.get_fusion_costs() == costs
+    missing = str(tmpdir.join("missing.json"))
+    untuned = Simulator(gate_fusion=True, fusion_profile=missing)
+    assert untuned._simulator.get_fusion_costs() == []
+    assert not tmpdir.join("missing.json").check()
+    other = Simulator(gate_fusion=True, precision='single',
+                      fusion_profile=profile)
+    assert other._simulator.get_fusion_costs() == []
+    assert not other.load_fusion_profile(profile)
+    monkeypatch.undo()
+
+    wavefunctions = []
+    for costs in ([], [1., 1., 1., 1.], [1., 3., 9.]):
+        sim = Simulator(gate_fusion=True, rnd_seed=1)
+        sim._simulator.set_fusion_costs(costs)
+        eng = MainEngine(sim, [])
+        qureg = eng.allocate_qureg(5)
+        All(H) | qureg
+        for i in range(4):
+            Rx(0.1 * i) | qureg[i]
+            CNOT | (qureg[i], qureg[i + 1])
+            with Control(eng, qureg[0]):
+                Ry(0.2) | qureg[4 - i]
+        eng.flush()
+        wavefunctions.append(numpy.array(sim.cheat()[1]))
+        All(Measure) | qureg
+    assert numpy.allclose(wavefunctions[0], wavefunctions[1])
+    assert numpy.allclose(wavefunctions[0], wavefunctions[2])
+
+
+def test_simulator_lookahead():
+    if "cpp_simulator" not in get_available_simulators():
+        pytest.skip("No C++ simulator")
+    wavefunctions = []
+    for lookahead in (0, 5, 64):
+        sim = Simulator(gate_fusion=True, rnd_seed=1, lookahead=lookahead)
+        assert sim._simulator.get_lookahead() == lookahead
+        eng = MainEngine(sim, [])
+        qureg = eng.allocate_qureg(8)
+        All(H) | qureg
+        # interleaved gates on two groups of qubits, with diagonal and
+        # controlled gates which (do not) commute with them
+        for i in range(3):
+            Rx(0.1 * i + 0.1) | qureg[i]
+            Ry(0.3) | qureg[4 + i]
+            CNOT | (qureg[i], qureg[i + 1])
+            Rz(0.2) | qureg[i + 1]
+            with Control(eng, qureg[0]):
+                Ry(0.4) | qureg[5 + i]
+            Swap | (qureg[4 + i], qureg[5 + i])
+        eng.flush()
+        wavefunctions.append(numpy.array(sim.cheat()[1]))
+        All(Measure) | qureg
+    assert numpy.allclose(wavefunctions[0], wavefunctions[1])
+    assert numpy.allclose(wavefunctions[0], wavefunctions[2])
+
+
+def test_simulator_allocate_qubits_reserve(sim):
+    backend = sim._simulator
+    backend.reserve(6)
+    misses = backend.get_buffer_statistics()["misses"]
+    eng = MainEngine(sim, [])
+    qureg = eng.allocate_qureg(6)
+    X | qureg[2]
+    eng.flush()
+    # the state vector was grown in place
+    assert backend.get_buffer_statistics()["misses"] == misses
+    assert len(sim.cheat()[1]) == 2 ** 6
+    assert sim.get_probability('001000', qureg) == pytest.approx(1.)
+    backend.allocate_qubits([100, 101])
+    assert len(sim.cheat()[1]) == 2 ** 8
+    assert abs(sim.cheat()[1][4]) == pytest.approx(1.)
+    with pytest.raises(RuntimeError):
+        backend.allocate_qubits([102, 102])
+    backend.deallocate_qubit(100)
+    backend.deallocate_qubit(101)
+    All(Measure) | qureg
+
+
+def test_simulator_sample(sim):
+    eng = MainEngine(sim, [])
+    qureg = eng.allocate_qureg(3)
+    Ry(2 * math.acos(math.sqrt(.8))) | qureg[0]
+    X | qureg[2]
+    eng.flush()
+    state = numpy.array(sim.cheat()[1])
+    samples = sim.sample([qureg[2], qureg[0]], 10000)
+    assert len(samples) == 10000
+    # the state is not collapsed
+    assert numpy.allclose(sim.cheat()[1], state)
+    assert set(samples) <= {1, 3}
+    assert numpy.mean(samples == 1) == pytest.approx(.8, abs=.05)
+    samples = sim.sample(qureg, 100)
+    assert set(samples) <= {4, 5}
+    All(Measure) | qureg
+
+
+def test_simulator_deferred_normalization(sim):
+    eng = MainEngine(sim, [])
+    qureg = eng.allocate_qureg(2)
+    H | qureg[0]
+    CNOT | (qureg[0], qureg[1])
+    Ry(.3) | qureg[1]
+    Measure | qureg[0]
+    eng.flush()
+    bits = [int(qureg[0]), 0]
+    # readers apply the pending normalization factor
+    assert sim.get_probability([bits[0]], [qureg[0]]) == pytest.approx(1.)
+    assert (abs(sim.get_amplitude(bits, qureg)) ** 2 +
+            abs(sim.get_amplitude([bits[0], 1], qureg)) ** 2 ==
+            pytest.approx(1.))
+    assert numpy.linalg.norm(sim.cheat()[1]) == pytest.approx(1.)
+    H | qureg[1]
+    sim.collapse_wavefunction([qureg[1]], [1])
+    Ry(.5) | qureg[1]
+    eng.flush()
+    assert numpy.linalg.norm(sim.cheat()[1]) == pytest.approx(1.)
+    All(Measure) | qureg
+
+
+def test_simulator_measure_and_release(sim):
+    backend = sim._simulator
+    ids = [200, 201, 202, 203, 204]
+    backend.allocate_qubits(ids)
+    backend.apply_controlled_gate(X.matrix.tolist(), [201], [])
+    backend.apply_controlled_gate(X.matrix.tolist(), [203], [])
+    backend.apply_controlled_gate(H.matrix.tolist(), [204], [])
+    with pytest.raises(RuntimeError):
+        backend.deallocate_qubits([200, 201, 204])
+    backend.deallocate_qubits([203, 200, 202])
+    assert len(sim.cheat()[1]) == 2 ** 2
+    assert backend.get_probability([1], [201]) == pytest.approx(1.)
+    result = backend.measure_and_release([204, 201])
+    assert result[1]
+    assert len(sim.cheat()[1]) == 1
+    assert abs(sim.cheat()[1][0]) == pytest.approx(1.)
+
+
+def test_simulator_concurrent_instances(sim):
+    if "cpp_simulator" not in get_available_simulators():
+        pytest.skip("No C++ simulator")
+    import threading
+    results = dict()
+
+    def run_circuit(index):
+        thread_sim = Simulator(gate_fusion=True, rnd_seed=index + 1)
+        eng = MainEngine(thread_sim, [])
+        qureg = eng.allocate_qureg(10)
+        All(H) | qureg
+        for qb in qureg[1:]:
+            CNOT | (qureg[0], qb)
+        Rz(0.1 * index) | qureg[0]
+        eng.flush()
+        results[index] = thread_sim.get_probability('0' * 10, qureg)
+        All(Measure) | qureg
+
+    threads = [threading.Thread(target=run_circuit, args=(i,))
+               for i in range(4)]
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+    assert len(results) == 4
+    for i in range(4):
+        assert results[i] == pytest.approx(1. / 2 ** 10)
+
+
 class MockSimulatorBackend(object):
     def __init__(self):
         self.run_cnt = 0
@@ -625,6 +1295,45 @@ def test_simulator_send():
     assert len(backend.received_commands) == 5
 
 
+class CountingSimulatorBackend(object):
+    """ Forwards all calls to a simulator backend and counts apply_commands """
+    def __init__(self, backend):
+        self._backend = backend
+        self.apply_cnt = 0
+
+    def apply_commands(self, program, matrices):
+        self.apply_cnt += 1
+        return self._backend.apply_commands(program, matrices)
+
+    def __getattr__(self, name):
+        return getattr(self._backend, name)
+
+
+def test_simulator_command_buffer(sim):
+    backend = CountingSimulatorBackend(sim._simulator)
+    sim._simulator = backend
+    eng = MainEngine(sim, [])
+    qureg = eng.allocate_qureg(3)
+    H | qureg[0]
+    CNOT | (qureg[0], qureg[1])
+    with Control(eng, qureg[1]):
+        X | qureg[2]
+    assert backend.apply_cnt == 0
+    eng.flush()
+    # one call for the whole circuit
+    assert backend.apply_cnt == 1
+    assert sim.get_probability('000', qureg) == pytest.approx(.5)
+    assert sim.get_probability('111', qureg) == pytest.approx(.5)
+    ancilla = eng.allocate_qubit()
+    X | ancilla
+    Measure | ancilla
+    # measurements are executed right away
+    assert backend.apply_cnt == 2
+    assert int(ancilla) == 1
+    All(Measure) | qureg
+    assert sum(int(qb) for qb in qureg) in (0, 3)
+
+
 def test_simulator_functional_entangle(sim):
     eng = MainEngine(sim, [])
     qubits = eng.allocate_qureg(5)
@@ -687,6 +1396,59 @@ def test_simulator_convert_logical_to_mapped_qubits(sim):
             qubit1 + qubit0)
 
 
+def test_simulator_constant_math_modular(sim):
+    from projectq.libs.math import AddConstantModN, MultiplyByConstantModN
+    eng = MainEngine(sim, [])
+    qureg = eng.allocate_qureg(4)
+    ctrl = eng.allocate_qubit()
+    eng.flush()
+
+    def init(num_values):
+        # register values < num_values only
+        state = numpy.array([float(i + 1) if (i & 15) < num_values else 0.
+                             for i in range(32)])
+        state /= numpy.linalg.norm(state)
+        sim.set_wavefunction(state, qureg + ctrl)
+        return state
+
+    def check(gate, controlled):
+        if controlled:
+            with Control(eng, ctrl):
+                gate | qureg
+        else:
+            gate | qureg
+        eng.flush()
+        fun = gate.get_math_function([qureg])
+        expected = numpy.zeros(32)
+        for i in range(32):
+            x = i & 15
+            if i >> 4 or not controlled:
+                x = fun([x])[0]
+            expected[x | (i & 16)] += state[i]
+        for i in range(32):
+            bits = [(i >> k) & 1 for k in range(5)]
+            assert (sim.get_amplitude(bits, qureg + ctrl) ==
+                    pytest.approx(expected[i]))
+        return expected
+
+    # in place
+    state = init(11)
+    state = check(AddConstantModN(7, 11), False)
+    state = check(AddConstantModN(-3, 11), False)
+    state = check(MultiplyByConstantModN(4, 11), False)
+    # controlled
+    state = check(AddConstantModN(9, 13), True)
+    state = check(MultiplyByConstantModN(5, 13), True)
+    # register values >= N (emulate_math, as the math function of the gate)
+    state = init(16)
+    state = check(AddConstantModN(7, 11), False)
+    state = init(16)
+    state = check(MultiplyByConstantModN(5, 13), True)
+    # not a bijection (emulate_math)
+    state = check(MultiplyByConstantModN(2, 10), True)
+    All(Measure) | qureg + ctrl
+
+
 def test_simulator_constant_math_emulation():
     if "cpp_simulator" not in get_available_simulators():
         pytest.skip("No C++ simulator")
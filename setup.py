@@ -363,22 +363,41 @@ class BuildExt(build_ext):
         important_msgs('WARNING: compiler does not support OpenMP!')
 
     def _configure_intrinsics(self):
-        for flag in [
-                '-march=native', '-mavx2', '/arch:AVX2', '/arch:CORE-AVX2',
-                '/arch:AVX'
-        ]:
-            if compiler_test(
-                    self.compiler,
-                    flagname=flag,
-                    link=False,
-                    include='#include <immintrin.h>',
-                    body='__m256d neg = _mm256_set1_pd(1.0); (void)neg;'):
-
-                if sys.platform == 'win32':
-                    self.opts.extend(('/DINTRIN', flag))
-                else:
-                    self.opts.extend(('-DINTRIN', flag))
-                break
+        # The AVX2 and AVX-512 kernels are compiled for their instruction set
+        # via target attributes and selected at runtime (CPUID). MSVC accepts
+        # the intrinsics without any flags.
+        if self.compiler.compiler_type == 'msvc':
+            include = '#include <immintrin.h>\n#include <intrin.h>'
+            body = ('int info[4]; __cpuidex(info, 7, 0);'
+                    '__m512d x = _mm512_set1_pd(1.0); (void)x;')
+        else:
+            include = ('#include <immintrin.h>\n'
+                       '__attribute__((target("avx512f,avx2,fma")))'
+                       '__m512d f(__m512d x)'
+                       '{ return _mm512_fmadd_pd(x, x, x); }')
+            body = ('__builtin_cpu_init();'
+                    '(void)__builtin_cpu_supports("avx512f");')
+        if compiler_test(self.compiler,
+                         link=False,
+                         include=include,
+                         body=body):
+            if sys.platform == 'win32':
+                self.opts.append('/DINTRIN')
+            else:
+                self.opts.append('-DINTRIN')
+        else:
+            important_msgs('WARNING: compiler does not support the AVX2 and '
+                           'AVX-512 kernels; using scalar kernels only!')
+
+        # -march=native lets the compiler use any instruction of the build
+        # host anywhere (e.g. BMI2 for the bit manipulations, AVX-512 in
+        # auto-vectorized loops), so the resulting binary may crash on other
+        # CPUs and the scalar kernels are no longer scalar. It is therefore
+        # only used if PROJECTQ_MARCH_NATIVE is set.
+        if (self.compiler.compiler_type != 'msvc'
+                and os.environ.get('PROJECTQ_MARCH_NATIVE')
+                and compiler_test(self.compiler, flagname='-march=native')):
+            self.opts.append('-march=native')
 
         #Not compatible with Qrack at "dirty qubit" tolerances for deallocation:
         #for flag in ['-ffast-math', '-fast', '/fast', '/fp:precise']: